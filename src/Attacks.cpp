@@ -0,0 +1,186 @@
+#include "Attacks.h"
+#include <cstring>
+
+Bitboard PawnAttackTable[2][64];
+Bitboard KnightAttackTable[64];
+Bitboard KingAttackTable[64];
+SlidingMagic RookMagics[64];
+SlidingMagic BishopMagics[64];
+Bitboard BetweenTable[64][64];
+Bitboard LineTable[64][64];
+
+namespace {
+
+Bitboard rookTable[0x19000];    // 102400 entries, sum of 2^bits over all squares
+Bitboard bishopTable[0x1480];   // 5248 entries
+
+const int ROOK_DIRECTIONS[4][2] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+const int BISHOP_DIRECTIONS[4][2] = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+// Set the bit for (rank, file) if it is on the board
+Bitboard squareIfValid(int rank, int file) {
+    if (rank < 0 || rank >= 8 || file < 0 || file >= 8) return 0;
+    return squareBit(rank * 8 + file);
+}
+
+// Slow ray walk, only used to fill the tables
+Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2]) {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; ++d) {
+        int rank = squareRank(square) + directions[d][0];
+        int file = squareCol(square) + directions[d][1];
+        while (rank >= 0 && rank < 8 && file >= 0 && file < 8) {
+            Bitboard bit = squareBit(rank * 8 + file);
+            attacks |= bit;
+            if (occupied & bit) break;
+            rank += directions[d][0];
+            file += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+// xorshift64*: deterministic, so every run finds the same magics quickly
+class MagicRandom {
+public:
+    explicit MagicRandom(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 2685821657736338717ULL;
+    }
+
+    // Magics with few set bits are found much faster
+    std::uint64_t sparse() { return next() & next() & next(); }
+
+private:
+    std::uint64_t state_;
+};
+
+void initSliders(SlidingMagic magics[64], Bitboard* table, const int directions[4][2]) {
+    Bitboard occupancy[4096];
+    Bitboard reference[4096];
+#if !CHESS_USE_PEXT
+    int epoch[4096];
+    std::memset(epoch, 0, sizeof(epoch));
+    int attempt = 0;
+
+    // Per-rank seeds known to find working magics within a few attempts
+    const std::uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+#endif
+
+    Bitboard* next = table;
+    for (int square = 0; square < 64; ++square) {
+        SlidingMagic& m = magics[square];
+
+        Bitboard edges = ((0xFFULL | 0xFF00000000000000ULL) & ~(0xFFULL << (squareRank(square) * 8))) |
+                         ((0x0101010101010101ULL | 0x8080808080808080ULL) &
+                          ~(0x0101010101010101ULL << squareCol(square)));
+        m.mask = slidingAttacks(square, 0, directions) & ~edges;
+        m.shift = 64 - popCount(m.mask);
+        m.attacks = next;
+
+        // Enumerate every subset of the mask (Carry-Rippler trick)
+        int size = 0;
+        Bitboard subset = 0;
+        do {
+            occupancy[size] = subset;
+            reference[size] = slidingAttacks(square, subset, directions);
+            ++size;
+            subset = (subset - m.mask) & m.mask;
+        } while (subset);
+
+#if CHESS_USE_PEXT
+        m.magic = 0;
+        for (int i = 0; i < size; ++i) {
+            next[m.index(occupancy[i])] = reference[i];
+        }
+#else
+        // Try random magics until one maps every subset without a destructive collision
+        MagicRandom random(seeds[squareRank(square)]);
+        for (;;) {
+            do {
+                m.magic = random.sparse();
+            } while (popCount((m.mask * m.magic) >> 56) < 6);
+
+            ++attempt;
+            int i = 0;
+            for (; i < size; ++i) {
+                unsigned idx = m.index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    next[idx] = reference[i];
+                } else if (next[idx] != reference[i]) {
+                    break;
+                }
+            }
+            if (i == size) break;
+        }
+#endif
+        next += size;
+    }
+}
+
+void initLeapers() {
+    const int knightSteps[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+    const int kingSteps[8][2] = {{1, 1}, {1, 0}, {1, -1}, {0, 1}, {0, -1}, {-1, 1}, {-1, 0}, {-1, -1}};
+
+    for (int square = 0; square < 64; ++square) {
+        int rank = squareRank(square);
+        int file = squareCol(square);
+
+        PawnAttackTable[0][square] = squareIfValid(rank + 1, file - 1) | squareIfValid(rank + 1, file + 1);
+        PawnAttackTable[1][square] = squareIfValid(rank - 1, file - 1) | squareIfValid(rank - 1, file + 1);
+
+        KnightAttackTable[square] = 0;
+        KingAttackTable[square] = 0;
+        for (int i = 0; i < 8; ++i) {
+            KnightAttackTable[square] |= squareIfValid(rank + knightSteps[i][0], file + knightSteps[i][1]);
+            KingAttackTable[square] |= squareIfValid(rank + kingSteps[i][0], file + kingSteps[i][1]);
+        }
+    }
+}
+
+// Needs the slider tables, so runs after initSliders
+void initLines() {
+    for (int a = 0; a < 64; ++a) {
+        for (int b = 0; b < 64; ++b) {
+            BetweenTable[a][b] = 0;
+            LineTable[a][b] = 0;
+            if (a == b) continue;
+
+            if (bishopAttacks(a, 0) & squareBit(b)) {
+                LineTable[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | squareBit(a) | squareBit(b);
+                BetweenTable[a][b] = bishopAttacks(a, squareBit(b)) & bishopAttacks(b, squareBit(a));
+            } else if (rookAttacks(a, 0) & squareBit(b)) {
+                LineTable[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | squareBit(a) | squareBit(b);
+                BetweenTable[a][b] = rookAttacks(a, squareBit(b)) & rookAttacks(b, squareBit(a));
+            }
+        }
+    }
+}
+
+struct AttackTablesInitializer {
+    AttackTablesInitializer() {
+        initLeapers();
+        initSliders(RookMagics, rookTable, ROOK_DIRECTIONS);
+        initSliders(BishopMagics, bishopTable, BISHOP_DIRECTIONS);
+        initLines();
+    }
+} attackTablesInitializer;
+
+} // namespace
+
+Bitboard pieceAttacks(PieceType type, int side, int square, Bitboard occupied) {
+    switch (type) {
+        case PieceType::PAWN: return pawnAttacks(side, square);
+        case PieceType::KNIGHT: return knightAttacks(square);
+        case PieceType::BISHOP: return bishopAttacks(square, occupied);
+        case PieceType::ROOK: return rookAttacks(square, occupied);
+        case PieceType::QUEEN: return queenAttacks(square, occupied);
+        case PieceType::KING: return kingAttacks(square);
+        default: return 0;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ATTACKS_H
+#define ATTACKS_H
+
+#include "Bitboard.h"
+#include "ChessPiece.h"
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#define CHESS_USE_PEXT 1
+#else
+#define CHESS_USE_PEXT 0
+#endif
+
+// Precomputed attack sets. Leapers are plain 64-entry tables; sliders use
+// "fancy" magic bitboards (or PEXT when the CPU has BMI2), so a rook, bishop
+// or queen gets its full attack set for any occupancy from one table lookup.
+// The tables are filled once by a static initializer in Attacks.cpp.
+
+struct SlidingMagic {
+    Bitboard mask;          // relevant occupancy, board edges excluded
+    Bitboard magic;
+    const Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#if CHESS_USE_PEXT
+        return static_cast<unsigned>(_pext_u64(occupied, mask));
+#else
+        return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+extern Bitboard PawnAttackTable[2][64];
+extern Bitboard KnightAttackTable[64];
+extern Bitboard KingAttackTable[64];
+extern SlidingMagic RookMagics[64];
+extern SlidingMagic BishopMagics[64];
+extern Bitboard BetweenTable[64][64];
+extern Bitboard LineTable[64][64];
+
+// side: 0 = white, 1 = black (see colorIndex)
+inline Bitboard pawnAttacks(int side, int square) { return PawnAttackTable[side][square]; }
+inline Bitboard knightAttacks(int square) { return KnightAttackTable[square]; }
+inline Bitboard kingAttacks(int square) { return KingAttackTable[square]; }
+
+inline Bitboard rookAttacks(int square, Bitboard occupied) {
+    const SlidingMagic& m = RookMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const SlidingMagic& m = BishopMagics[square];
+    return m.attacks[m.index(occupied)];
+}
+
+inline Bitboard queenAttacks(int square, Bitboard occupied) {
+    return rookAttacks(square, occupied) | bishopAttacks(square, occupied);
+}
+
+// Squares strictly between a and b if they share a rank, file or diagonal, else empty
+inline Bitboard betweenSquares(int a, int b) { return BetweenTable[a][b]; }
+// The whole rank, file or diagonal through a and b, or empty if there is none
+inline Bitboard lineThrough(int a, int b) { return LineTable[a][b]; }
+
+// Squares attacked by a piece of the given type and color standing on square
+Bitboard pieceAttacks(PieceType type, int side, int square, Bitboard occupied);
+
+#endif
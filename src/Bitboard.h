@@ -0,0 +1,47 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// A bitboard holds one bit per square. Squares are numbered a1 = 0 ... h8 = 63,
+// so the GUI's row 7 (white's back rank) is rank 1 and row 0 is rank 8.
+using Bitboard = std::uint64_t;
+
+const int NO_SQUARE = -1;
+
+inline int makeSquare(int row, int col) { return (7 - row) * 8 + col; }
+inline int squareRow(int square) { return 7 - (square >> 3); }
+inline int squareCol(int square) { return square & 7; }
+inline int squareRank(int square) { return square >> 3; }
+
+inline Bitboard squareBit(int square) { return Bitboard(1) << square; }
+
+inline int popCount(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt64(b));
+#else
+    return __builtin_popcountll(b);
+#endif
+}
+
+// Index of the least significant set bit. Undefined for an empty board.
+inline int lsb(Bitboard b) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward64(&index, b);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(b);
+#endif
+}
+
+inline int popLsb(Bitboard& b) {
+    int square = lsb(b);
+    b &= b - 1;
+    return square;
+}
+
+#endif
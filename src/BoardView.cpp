@@ -0,0 +1,325 @@
+#include "BoardView.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// Atlas cell order: white pawn, rook, knight, bishop, queen, king, then
+// black; pieceKind() maps a piece to its cell
+const char* const PIECE_FILES[BoardView::PIECE_KINDS] = {
+    "wp.png", "wr.png", "wn.png", "wb.png", "wq.png", "wk.png",
+    "bp.png", "br.png", "bn.png", "bb.png", "bq.png", "bk.png"
+};
+
+const float PI = 3.14159265f;
+const int CIRCLE_SEGMENTS = 24;
+
+int pieceKind(PieceType type, PieceColor color) {
+    return 6 * colorIndex(color) + static_cast<int>(type) - 1;
+}
+
+// All shapes are triangle lists, so one vertex array holds any mix of them
+
+void addTriangle(sf::VertexArray& vertices, sf::Vector2f a, sf::Vector2f b, sf::Vector2f c, sf::Color color) {
+    vertices.append(sf::Vertex{a, color});
+    vertices.append(sf::Vertex{b, color});
+    vertices.append(sf::Vertex{c, color});
+}
+
+void addRectangle(sf::VertexArray& vertices, sf::Vector2f position, sf::Vector2f size, sf::Color color) {
+    sf::Vector2f topRight(position.x + size.x, position.y);
+    sf::Vector2f bottomLeft(position.x, position.y + size.y);
+    sf::Vector2f bottomRight(position.x + size.x, position.y + size.y);
+    addTriangle(vertices, position, topRight, bottomRight, color);
+    addTriangle(vertices, position, bottomRight, bottomLeft, color);
+}
+
+// Outline drawn inside the rectangle
+void addFrame(sf::VertexArray& vertices, sf::Vector2f position, float size, float thickness, sf::Color color) {
+    addRectangle(vertices, position, sf::Vector2f(size, thickness), color);
+    addRectangle(vertices, sf::Vector2f(position.x, position.y + size - thickness), sf::Vector2f(size, thickness), color);
+    addRectangle(vertices, sf::Vector2f(position.x, position.y + thickness),
+                 sf::Vector2f(thickness, size - 2 * thickness), color);
+    addRectangle(vertices, sf::Vector2f(position.x + size - thickness, position.y + thickness),
+                 sf::Vector2f(thickness, size - 2 * thickness), color);
+}
+
+sf::Vector2f pointOnCircle(sf::Vector2f center, float radius, int segment) {
+    float angle = 2 * PI * segment / CIRCLE_SEGMENTS;
+    return sf::Vector2f(center.x + radius * std::cos(angle), center.y + radius * std::sin(angle));
+}
+
+void addDisc(sf::VertexArray& vertices, sf::Vector2f center, float radius, sf::Color color) {
+    for (int i = 0; i < CIRCLE_SEGMENTS; ++i) {
+        addTriangle(vertices, center, pointOnCircle(center, radius, i), pointOnCircle(center, radius, i + 1), color);
+    }
+}
+
+void addRing(sf::VertexArray& vertices, sf::Vector2f center, float radius, float thickness, sf::Color color) {
+    for (int i = 0; i < CIRCLE_SEGMENTS; ++i) {
+        sf::Vector2f outer0 = pointOnCircle(center, radius, i), outer1 = pointOnCircle(center, radius, i + 1);
+        sf::Vector2f inner0 = pointOnCircle(center, radius - thickness, i);
+        sf::Vector2f inner1 = pointOnCircle(center, radius - thickness, i + 1);
+        addTriangle(vertices, outer0, outer1, inner1, color);
+        addTriangle(vertices, outer0, inner1, inner0, color);
+    }
+}
+
+} // namespace
+
+BoardView::BoardView(ChessBoard& board)
+    : board_(board), tablebases_(nullptr), selectedRow_(-1), selectedCol_(-1), hasSelected_(false),
+      squares_(sf::PrimitiveType::Triangles), pieces_(sf::PrimitiveType::Triangles),
+      overlays_(sf::PrimitiveType::Triangles), geometryKey_(0), geometryPly_(-1), geometryDirty_(true) {}
+
+// Loads the twelve piece images and packs them side by side into one
+// texture, so every piece is drawn from the same texture in one call.
+// Returns false if any image is missing; the ones found are still used.
+bool BoardView::loadTextures() {
+    // Try different possible paths for resources
+    std::vector<std::string> possiblePaths = {
+        "resources/",               // Build directory (after CMake copy)
+        "../resources/",            // Relative from build directory
+        "../../resources/",         // Further up if needed
+        "../src/resources/",        // Development path
+        "../../src/resources/"      // Further up development path
+    };
+    
+    std::vector<sf::Image> images(PIECE_KINDS);
+    bool loaded[PIECE_KINDS] = {};
+    bool allLoaded = true;
+    for (int kind = 0; kind < PIECE_KINDS; ++kind) {
+        pieceRects_[kind] = sf::FloatRect();
+        
+        // Try each possible path
+        for (const auto& path : possiblePaths) {
+            std::string fullPath = path + PIECE_FILES[kind];
+            std::cout << "Trying to load texture: " << fullPath << std::endl;
+            
+            if (loadImage(images[kind], fullPath)) {
+                std::cout << "Successfully loaded: " << fullPath << std::endl;
+                loaded[kind] = true;
+                break;
+            }
+        }
+        
+        if (!loaded[kind]) {
+            std::cerr << "Failed to load texture: " << PIECE_FILES[kind] << " from any path" << std::endl;
+            allLoaded = false;
+        }
+    }
+    geometryDirty_ = true;
+
+    // One row of cells as large as the largest image. Kinds without an
+    // image keep an empty rect and are drawn as plain tokens instead.
+    sf::Vector2u cell;
+    for (int kind = 0; kind < PIECE_KINDS; ++kind) {
+        if (!loaded[kind]) continue;
+        cell.x = std::max(cell.x, images[kind].getSize().x);
+        cell.y = std::max(cell.y, images[kind].getSize().y);
+    }
+    if (cell.x == 0 || cell.y == 0) {
+        std::cerr << "No piece images, drawing plain tokens" << std::endl;
+        return false;
+    }
+    sf::Image atlas(sf::Vector2u(cell.x * PIECE_KINDS, cell.y), sf::Color::Transparent);
+    for (int kind = 0; kind < PIECE_KINDS; ++kind) {
+        if (!loaded[kind]) continue;
+        sf::Vector2u origin(cell.x * kind, 0);
+        if (!atlas.copy(images[kind], origin)) {
+            std::cerr << "Cannot pack " << PIECE_FILES[kind] << " into the piece atlas" << std::endl;
+            allLoaded = false;
+            continue;
+        }
+        pieceRects_[kind] = sf::FloatRect(sf::Vector2f(origin), sf::Vector2f(images[kind].getSize()));
+    }
+    if (!atlas_.loadFromImage(atlas)) {
+        std::cerr << "Cannot create the piece atlas texture, drawing plain tokens" << std::endl;
+        for (sf::FloatRect& rect : pieceRects_) rect = sf::FloatRect();
+        return false;
+    }
+    atlas_.setSmooth(true);     // pieces are scaled to the square size
+    std::cout << (allLoaded ? "All" : "Some") << " textures loaded into a " << cell.x * PIECE_KINDS << "x"
+              << cell.y << " atlas" << std::endl;
+    return allLoaded;
+}
+
+bool BoardView::loadImage(sf::Image& image, const std::string& filename) {
+    // Check if file exists
+    std::ifstream file(filename);
+    if (!file.good()) {
+        std::cerr << "File does not exist: " << filename << std::endl;
+        return false;
+    }
+    file.close();
+    
+    if (image.loadFromFile(filename)) {
+        std::cout << "Image loaded successfully, size: "
+                  << image.getSize().x << "x" << image.getSize().y << std::endl;
+        return true;
+    }
+    
+    std::cerr << "SFML failed to load image: " << filename << std::endl;
+    return false;
+}
+
+// Three draw calls: squares, pieces from the atlas, then highlights on top
+void BoardView::draw(sf::RenderWindow& window) {
+    if (geometryDirty_ || geometryKey_ != board_.getKey() || geometryPly_ != board_.getHistorySize()) {
+        rebuildGeometry();
+    }
+    window.draw(squares_);
+    window.draw(pieces_, sf::RenderStates(&atlas_));
+    window.draw(overlays_);
+}
+
+void BoardView::rebuildGeometry() {
+    squares_.clear();
+    pieces_.clear();
+    overlays_.clear();
+    const sf::Vector2f squareSize(SQUARE_SIZE, SQUARE_SIZE);
+
+    for (int row = 0; row < 8; ++row) {
+        for (int col = 0; col < 8; ++col) {
+            addRectangle(squares_, squareOrigin(row, col), squareSize, getSquareColor(row, col));
+        }
+    }
+
+    const Position& position = board_.getPosition();
+    for (Bitboard occupied = position.occupied(); occupied; ) {
+        int square = popLsb(occupied);
+        PieceColor color = position.pieceColorAt(square);
+        const sf::FloatRect& rect = pieceRects_[pieceKind(position.pieceTypeAt(square), color)];
+        sf::Vector2f origin = squareOrigin(squareRow(square), squareCol(square));
+        if (rect.size.x <= 0) {
+            // No image for this piece: a token in its color, under the pieces
+            const float inset = SQUARE_SIZE / 4;
+            sf::Color fill = color == PieceColor::WHITE ? sf::Color(245, 245, 245) : sf::Color(30, 30, 30);
+            addRectangle(squares_, sf::Vector2f(origin.x + inset, origin.y + inset),
+                         sf::Vector2f(SQUARE_SIZE - 2 * inset, SQUARE_SIZE - 2 * inset), fill);
+            addFrame(squares_, sf::Vector2f(origin.x + inset, origin.y + inset), SQUARE_SIZE - 2 * inset, 2,
+                     sf::Color(128, 128, 128));
+            continue;
+        }
+        sf::Vector2f corners[4] = {origin, sf::Vector2f(origin.x + SQUARE_SIZE, origin.y),
+                                   sf::Vector2f(origin.x + SQUARE_SIZE, origin.y + SQUARE_SIZE),
+                                   sf::Vector2f(origin.x, origin.y + SQUARE_SIZE)};
+        sf::Vector2f texture[4] = {rect.position, sf::Vector2f(rect.position.x + rect.size.x, rect.position.y),
+                                   rect.position + rect.size, sf::Vector2f(rect.position.x, rect.position.y + rect.size.y)};
+        const int order[6] = {0, 1, 2, 0, 2, 3};
+        for (int i : order) pieces_.append(sf::Vertex{corners[i], sf::Color::White, texture[i]});
+    }
+
+    addHangingPieces();
+    addSelection();
+    addValidMoves();
+
+    geometryKey_ = board_.getKey();
+    geometryPly_ = board_.getHistorySize();
+    geometryDirty_ = false;
+}
+
+sf::Vector2f BoardView::squareOrigin(int row, int col) {
+    return sf::Vector2f(BOARD_OFFSET_X + col * SQUARE_SIZE, BOARD_OFFSET_Y + row * SQUARE_SIZE);
+}
+
+void BoardView::addSelection() {
+    if (hasSelected_) {
+        addRectangle(overlays_, squareOrigin(selectedRow_, selectedCol_), sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE),
+                     sf::Color(255, 255, 0, 100)); // Semi-transparent yellow
+    }
+}
+
+// Frames pieces that can be won by a capture: red for the side to move's
+// own pieces, green for the opponent's
+void BoardView::addHangingPieces() {
+    PieceColor toMove = board_.getCurrentPlayer();
+    Bitboard own = board_.getHangingPieces(toMove);
+    Bitboard enemy = board_.getHangingPieces(oppositeColor(toMove));
+    for (Bitboard pieces = own | enemy; pieces; ) {
+        int square = popLsb(pieces);
+        addFrame(overlays_, squareOrigin(squareRow(square), squareCol(square)), SQUARE_SIZE, 3,
+                 (own & squareBit(square)) ? sf::Color(220, 40, 40, 180) : sf::Color(40, 180, 40, 180));
+    }
+}
+
+void BoardView::addValidMoves() {
+    if (hasSelected_) {
+        MoveList validMoves = board_.getValidMoves(selectedRow_, selectedCol_);
+        const Position& position = board_.getPosition();
+        for (Move move : validMoves) {
+            sf::Vector2f origin = squareOrigin(squareRow(move.to()), squareCol(move.to()));
+            sf::Vector2f center(origin.x + SQUARE_SIZE / 2, origin.y + SQUARE_SIZE / 2);
+
+            // Captures are ringed by how the exchange on the square ends
+            if (!position.isEmpty(move.to()) || move.isEnPassant()) {
+                int exchange = board_.see(move);
+                addRing(overlays_, center, SQUARE_SIZE / 2 - 4, 4,
+                        exchange > 0 ? sf::Color(0, 200, 0, 160)           // winning
+                        : exchange == 0 ? sf::Color(230, 190, 0, 160)      // equal
+                        : sf::Color(220, 0, 0, 160));                      // losing
+            } else {
+                addDisc(overlays_, center, 8, sf::Color(0, 255, 0, 100)); // Semi-transparent green
+            }
+        }
+    }
+}
+
+// ========== handleClick METHOD - CORRECTED ==========
+// FIXED: Removed switchPlayer() call to prevent double switching
+void BoardView::handleClick(int x, int y) {
+    int col = (x - BOARD_OFFSET_X) / SQUARE_SIZE;
+    int row = (y - BOARD_OFFSET_Y) / SQUARE_SIZE;
+    
+    if (row < 0 || row >= 8 || col < 0 || col >= 8) return;
+    
+    geometryDirty_ = true;
+    if (hasSelected_) {
+        if (board_.movePiece(selectedRow_, selectedCol_, row, col)) {
+            printStatus();
+            // REMOVED: switchPlayer(); - Now handled in movePiece() for all moves
+        }
+        hasSelected_ = false;
+    } else {
+        if (board_.getPiece(row, col).getColor() == board_.getCurrentPlayer()) {
+            selectedRow_ = row;
+            selectedCol_ = col;
+            hasSelected_ = true;
+        }
+    }
+}
+
+void BoardView::printStatus() const {
+    // One cached move generation answers all of these
+    PieceColor toMove = board_.getCurrentPlayer();
+    GameStatus status = board_.getStatus();
+    if (status == GameStatus::CHECKMATE) {
+        std::cout << "Checkmate! " << (toMove == PieceColor::WHITE ? "Black" : "White") << " wins!" << std::endl;
+    } else if (status == GameStatus::STALEMATE) {
+        std::cout << "Stalemate! The game is a draw." << std::endl;
+    } else if (board_.isThreefoldRepetition()) {
+        std::cout << "Threefold repetition! The game is a draw." << std::endl;
+    } else if (status == GameStatus::CHECK) {
+        std::cout << "Check!" << std::endl;
+    }
+
+    std::string tablebase = tablebaseStatus();
+    if (!tablebase.empty()) std::cout << "Tablebase: " << tablebase << std::endl;
+}
+
+std::string BoardView::tablebaseStatus() const {
+    TablebaseResult result;
+    if (!tablebases_ || !tablebases_->probe(board_, result)) return "";
+    if (result.outcome == TablebaseResult::DRAW) return "Draw";
+    if (result.plies == 0) return "";     // already mated
+    bool whiteToMove = board_.getCurrentPlayer() == PieceColor::WHITE;
+    bool whiteWins = (result.outcome == TablebaseResult::WIN) == whiteToMove;
+    return std::string(whiteWins ? "White" : "Black") + " mates in " + std::to_string(result.mateInMoves());
+}
+
+sf::Color BoardView::getSquareColor(int row, int col) const {
+    return (row + col) % 2 == 0 ? sf::Color(240, 217, 181) : sf::Color(181, 136, 99);
+}
@@ -0,0 +1,66 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include "ChessBoard.h"
+#include "Tablebase.h"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
+
+// SFML front end for a ChessBoard: textures, drawing and mouse selection.
+// All rules live in ChessBoard, which has no graphics dependency.
+//
+// The piece images are packed into one atlas texture, and the board,
+// pieces and highlights live in three vertex arrays that are rebuilt only
+// when the position or the selection changes, so a frame is three draw
+// calls.
+class BoardView {
+public:
+    explicit BoardView(ChessBoard& board);
+
+    bool loadTextures();
+    bool loadFont();
+    void draw(sf::RenderWindow& window);
+    void handleClick(int x, int y);
+    // Print checkmate, stalemate, repetition or check for the side to move,
+    // and the tablebase result when the tables cover the position
+    void printStatus() const;
+    // "White mates in 12", "Draw" and so on, or empty if no table covers
+    // the position
+    std::string tablebaseStatus() const;
+    void setTablebases(const Tablebases* tablebases) { tablebases_ = tablebases; }
+
+    static const int PIECE_KINDS = 12;
+
+private:
+    static const int SQUARE_SIZE = 80;
+    static const int BOARD_OFFSET_X = 50;
+    static const int BOARD_OFFSET_Y = 50;
+
+    ChessBoard& board_;
+    const Tablebases* tablebases_;
+    int selectedRow_;
+    int selectedCol_;
+    bool hasSelected_;
+    sf::Texture atlas_;
+    sf::FloatRect pieceRects_[PIECE_KINDS];     // texture coordinates in atlas_
+    sf::Font font_;
+
+    // Cached geometry and the state it was built for
+    sf::VertexArray squares_;
+    sf::VertexArray pieces_;
+    sf::VertexArray overlays_;
+    std::uint64_t geometryKey_;
+    int geometryPly_;
+    bool geometryDirty_;
+
+    bool loadImage(sf::Image& image, const std::string& filename);
+    void rebuildGeometry();
+    void addSelection();
+    void addHangingPieces();
+    void addValidMoves();
+    static sf::Vector2f squareOrigin(int row, int col);
+    sf::Color getSquareColor(int row, int col) const;
+};
+
+#endif
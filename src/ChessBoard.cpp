@@ -1,611 +1,333 @@
 #include "ChessBoard.h"
+#include "Attacks.h"
+#include "Evaluate.h"
+#include "MoveGen.h"
+#include <algorithm>
+#include <cassert>
 #include <iostream>
-#include <fstream>
-#include <vector>
-
-// ========== CONSTRUCTOR - UPDATED ==========
-// CHANGES: Added initialization of enPassantTargetRow_ and enPassantTargetCol_ to -1
-// WHY: Need to track which square is vulnerable to en passant capture
-// ADDED: Castling tracking variables initialization
-ChessBoard::ChessBoard() : currentPlayer_(PieceColor::WHITE), selectedRow_(-1), selectedCol_(-1), 
-                          hasSelected_(false), enPassantTargetRow_(-1), enPassantTargetCol_(-1),
-                          // ADDED: Castling initialization
-                          whiteKingMoved_(false), blackKingMoved_(false),
-                          whiteRookKingSideMoved_(false), whiteRookQueenSideMoved_(false),
-                          blackRookKingSideMoved_(false), blackRookQueenSideMoved_(false) {
-    // Initialize board with nullptrs
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            board_[i][j] = nullptr;
-        }
-    }
+
+ChessBoard::ChessBoard()
+    : historySize_(0), network_(nullptr), status_(GameStatus::NORMAL), legalMovesValid_(false) {
     initializeBoard();
 }
 
 ChessBoard::~ChessBoard() {
-    // Smart pointers will handle cleanup
 }
 
 void ChessBoard::initializeBoard() {
-    // Set up pawns
-    for (int col = 0; col < 8; ++col) {
-        board_[1][col] = std::make_shared<ChessPiece>(PieceType::PAWN, PieceColor::BLACK, 1, col);
-        board_[6][col] = std::make_shared<ChessPiece>(PieceType::PAWN, PieceColor::WHITE, 6, col);
-    }
-    
-    // Set up other pieces
-    // Black pieces
-    board_[0][0] = std::make_shared<ChessPiece>(PieceType::ROOK, PieceColor::BLACK, 0, 0);
-    board_[0][1] = std::make_shared<ChessPiece>(PieceType::KNIGHT, PieceColor::BLACK, 0, 1);
-    board_[0][2] = std::make_shared<ChessPiece>(PieceType::BISHOP, PieceColor::BLACK, 0, 2);
-    board_[0][3] = std::make_shared<ChessPiece>(PieceType::QUEEN, PieceColor::BLACK, 0, 3);
-    board_[0][4] = std::make_shared<ChessPiece>(PieceType::KING, PieceColor::BLACK, 0, 4);
-    board_[0][5] = std::make_shared<ChessPiece>(PieceType::BISHOP, PieceColor::BLACK, 0, 5);
-    board_[0][6] = std::make_shared<ChessPiece>(PieceType::KNIGHT, PieceColor::BLACK, 0, 6);
-    board_[0][7] = std::make_shared<ChessPiece>(PieceType::ROOK, PieceColor::BLACK, 0, 7);
-    
-    // White pieces
-    board_[7][0] = std::make_shared<ChessPiece>(PieceType::ROOK, PieceColor::WHITE, 7, 0);
-    board_[7][1] = std::make_shared<ChessPiece>(PieceType::KNIGHT, PieceColor::WHITE, 7, 1);
-    board_[7][2] = std::make_shared<ChessPiece>(PieceType::BISHOP, PieceColor::WHITE, 7, 2);
-    board_[7][3] = std::make_shared<ChessPiece>(PieceType::QUEEN, PieceColor::WHITE, 7, 3);
-    board_[7][4] = std::make_shared<ChessPiece>(PieceType::KING, PieceColor::WHITE, 7, 4);
-    board_[7][5] = std::make_shared<ChessPiece>(PieceType::BISHOP, PieceColor::WHITE, 7, 5);
-    board_[7][6] = std::make_shared<ChessPiece>(PieceType::KNIGHT, PieceColor::WHITE, 7, 6);
-    board_[7][7] = std::make_shared<ChessPiece>(PieceType::ROOK, PieceColor::WHITE, 7, 7);
+    position_.setStartPosition();
+    historySize_ = 0;
+    legalMovesValid_ = false;
+    updateAttacks();
+    refreshAccumulator();
 }
 
-bool ChessBoard::loadTextures() {
-    // Try different possible paths for resources
-    std::vector<std::string> possiblePaths = {
-        "resources/",               // Build directory (after CMake copy)
-        "../resources/",            // Relative from build directory
-        "../../resources/",         // Further up if needed
-        "../src/resources/",        // Development path
-        "../../src/resources/"      // Further up development path
-    };
-    
-    std::vector<std::pair<std::string, std::string>> textureFiles = {
-        {"white_pawn", "wp.png"},
-        {"white_rook", "wr.png"},
-        {"white_knight", "wn.png"},
-        {"white_bishop", "wb.png"},
-        {"white_queen", "wq.png"},
-        {"white_king", "wk.png"},
-        {"black_pawn", "bp.png"},
-        {"black_rook", "br.png"},
-        {"black_knight", "bn.png"},
-        {"black_bishop", "bb.png"},
-        {"black_queen", "bq.png"},
-        {"black_king", "bk.png"}
-    };
-    
-    bool allLoaded = true;
-    for (const auto& [name, filename] : textureFiles) {
-        bool loaded = false;
-        
-        // Try each possible path
-        for (const auto& path : possiblePaths) {
-            std::string fullPath = path + filename;
-            std::cout << "Trying to load texture: " << fullPath << std::endl;
-            
-            if (loadTexture(name, fullPath)) {
-                std::cout << "Successfully loaded: " << fullPath << std::endl;
-                loaded = true;
-                break;
-            }
-        }
-        
-        if (!loaded) {
-            std::cerr << "Failed to load texture: " << filename << " from any path" << std::endl;
-            allLoaded = false;
-        }
-    }
-    
-    if (allLoaded) {
-        std::cout << "All textures loaded successfully!" << std::endl;
-    } else {
-        std::cerr << "Some textures failed to load!" << std::endl;
-    }
-    
-    return allLoaded;
+void ChessBoard::setPosition(const Position& position) {
+    position_ = position;
+    historySize_ = 0;
+    legalMovesValid_ = false;
+    updateAttacks();
+    refreshAccumulator();
 }
 
-bool ChessBoard::loadTexture(const std::string& name, const std::string& filename) {
-    // Check if file exists
-    std::ifstream file(filename);
-    if (!file.good()) {
-        std::cerr << "File does not exist: " << filename << std::endl;
-        return false;
-    }
-    file.close();
-    
-    sf::Texture texture;
-    if (texture.loadFromFile(filename)) {
-        textures_[name] = texture;
-        std::cout << "Texture '" << name << "' loaded successfully, size: " 
-                  << texture.getSize().x << "x" << texture.getSize().y << std::endl;
-        return true;
+bool ChessBoard::setFen(const std::string& fen) {
+    Position position;
+    if (!position.setFromFen(fen)) return false;
+    setPosition(position);
+    return true;
+}
+
+std::uint64_t ChessBoard::perft(int depth) {
+    if (depth == 0) return 1;
+
+    MoveList moves;
+    getLegalMoves(moves);
+    if (depth == 1) return moves.size();    // bulk-count the last ply
+
+    std::uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        makeMove(move);
+        nodes += perft(depth - 1);
+        unmakeMove();
     }
-    
-    std::cerr << "SFML failed to load texture: " << filename << std::endl;
-    return false;
+    return nodes;
 }
 
-std::shared_ptr<ChessPiece> ChessBoard::getPiece(int row, int col) const {
-    if (row < 0 || row >= 8 || col < 0 || col >= 8) return nullptr;
-    return board_[row][col];
+void ChessBoard::makeMove(const Move& move) {
+    assert(historySize_ < MAX_HISTORY);
+    HistoryEntry& entry = history_[historySize_++];
+    entry.attacks[0] = attacks_[0];
+    entry.attacks[1] = attacks_[1];
+    position_.doMove(move, entry.undo);
+    legalMovesValid_ = false;
+    updateAttacks();
+    if (network_) updateAccumulator(entry.undo);
 }
 
-// ========== movePiece METHOD - CORRECTED ==========
-// FIXED: Proper turn switching for both castling and regular moves
-bool ChessBoard::movePiece(int fromRow, int fromCol, int toRow, int toCol) {
-    auto piece = board_[fromRow][fromCol];
-    if (!piece || piece->getColor() != currentPlayer_) return false;
-
-    // Get valid moves first to check if castling is possible
-    auto validMoves = getValidMoves(fromRow, fromCol);
-    bool isValidMove = false;
-    for (const auto& move : validMoves) {
-        if (move.first == toRow && move.second == toCol) {
-            isValidMove = true;
-            break;
-        }
-    }
-    if (!isValidMove) return false;
-
-    bool isCastlingMove = false;
-
-    // CHECK FOR CASTLING FIRST
-    if (piece->getType() == PieceType::KING && std::abs(toCol - fromCol) == 2) {
-        // This is a castling move
-        isCastlingMove = true;
-        if (toCol > fromCol) {
-            // Kingside castling
-            performCastleKingSide(currentPlayer_);
-            std::cout << "Kingside castling!" << std::endl;
-        } else {
-            // Queenside castling
-            performCastleQueenSide(currentPlayer_);
-            std::cout << "Queenside castling!" << std::endl;
-        }
-        
-        // Update king moved status
-        if (currentPlayer_ == PieceColor::WHITE) {
-            whiteKingMoved_ = true;
-        } else {
-            blackKingMoved_ = true;
-        }
-        
-        clearEnPassantTarget();
-    } else {
-        // ========== REGULAR MOVE (NON-CASTLING) ==========
-        
-        // ========== EN PASSANT CAPTURE LOGIC ==========
-        if (piece->getType() == PieceType::PAWN && 
-            fromCol != toCol &&                    
-            !board_[toRow][toCol]) {               
-            if (toRow == enPassantTargetRow_ && toCol == enPassantTargetCol_) {
-                int capturedPawnRow = fromRow;
-                int capturedPawnCol = toCol;
-                if (capturedPawnRow >= 0 && capturedPawnRow < 8 && capturedPawnCol >= 0 && capturedPawnCol < 8) {
-                    board_[capturedPawnRow][capturedPawnCol] = nullptr;
-                    std::cout << "En passant capture! Removed pawn at " << capturedPawnRow << "," << capturedPawnCol << std::endl;
-                }
-            }
-        }
+void ChessBoard::unmakeMove() {
+    assert(historySize_ > 0);
+    const HistoryEntry& entry = history_[--historySize_];
+    position_.undoMove(entry.undo);
+    legalMovesValid_ = false;
+    attacks_[0] = entry.attacks[0];
+    attacks_[1] = entry.attacks[1];
+    kingSquares_[0] = position_.kingSquare(PieceColor::WHITE);
+    kingSquares_[1] = position_.kingSquare(PieceColor::BLACK);
+}
 
-        // Track rook and king movement for castling
-        if (piece->getType() == PieceType::KING) {
-            if (currentPlayer_ == PieceColor::WHITE) {
-                whiteKingMoved_ = true;
-            } else {
-                blackKingMoved_ = true;
+void ChessBoard::updateAttacks() {
+    attacks_[0] = position_.attackedSquares(PieceColor::WHITE);
+    attacks_[1] = position_.attackedSquares(PieceColor::BLACK);
+    kingSquares_[0] = position_.kingSquare(PieceColor::WHITE);
+    kingSquares_[1] = position_.kingSquare(PieceColor::BLACK);
+}
+
+// Swap list: gain[d] is what the side making capture d stands to win if the
+// sequence stopped there; folding it back from the end lets each side stop
+// as soon as recapturing no longer pays
+int ChessBoard::see(const Move& move) const {
+    if (move.isCastling()) return 0;
+    int to = move.to();
+    PieceColor side = position_.pieceColorAt(move.from());
+    PieceType onSquare = move.isPromotion() ? move.promotion() : position_.pieceTypeAt(move.from());
+
+    int gain[32];
+    gain[0] = pieceValue(move.isEnPassant() ? PieceType::PAWN : position_.pieceTypeAt(to));
+    if (move.isPromotion()) gain[0] += pieceValue(move.promotion()) - pieceValue(PieceType::PAWN);
+
+    Bitboard occupied = position_.occupied() ^ squareBit(move.from());
+    if (move.isEnPassant()) occupied ^= squareBit(side == PieceColor::WHITE ? to - 8 : to + 8);
+    Bitboard diagonal = position_.pieces(PieceType::BISHOP) | position_.pieces(PieceType::QUEEN);
+    Bitboard straight = position_.pieces(PieceType::ROOK) | position_.pieces(PieceType::QUEEN);
+    Bitboard attackers = position_.attackersTo(to, occupied) & occupied;
+
+    const PieceType order[6] = {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP,
+                                PieceType::ROOK, PieceType::QUEEN, PieceType::KING};
+    int depth = 0;
+    for (side = oppositeColor(side); ; side = oppositeColor(side)) {
+        Bitboard ours = attackers & position_.pieces(side);
+        if (!ours) break;
+        PieceType type = PieceType::NONE;
+        Bitboard candidates = 0;
+        for (PieceType next : order) {
+            candidates = ours & position_.pieces(next);
+            if (candidates) {
+                type = next;
+                break;
             }
         }
-        
-        // Track rook movement
-        if (piece->getType() == PieceType::ROOK) {
-            if (fromRow == 0 && fromCol == 0) blackRookQueenSideMoved_ = true;
-            if (fromRow == 0 && fromCol == 7) blackRookKingSideMoved_ = true;
-            if (fromRow == 7 && fromCol == 0) whiteRookQueenSideMoved_ = true;
-            if (fromRow == 7 && fromCol == 7) whiteRookKingSideMoved_ = true;
+        // The king may only take last
+        if (type == PieceType::KING && (attackers & position_.pieces(oppositeColor(side)))) break;
+
+        ++depth;
+        gain[depth] = pieceValue(onSquare) - gain[depth - 1];
+        onSquare = type;
+        occupied ^= squareBit(lsb(candidates));
+        if (type == PieceType::PAWN || type == PieceType::BISHOP || type == PieceType::QUEEN) {
+            attackers |= bishopAttacks(to, occupied) & diagonal;
         }
-        
-        // Make the move for non-castling moves
-        board_[toRow][toCol] = piece;
-        board_[fromRow][fromCol] = nullptr;
-        piece->setPosition(toRow, toCol);
-        piece->setMoved(true);
-        
-        // ========== EN PASSANT TARGET SETTING ==========
-        if (piece->getType() == PieceType::PAWN && std::abs(toRow - fromRow) == 2) {
-            int enPassantRow = (currentPlayer_ == PieceColor::WHITE) ? toRow + 1 : toRow - 1;
-            setEnPassantTarget(enPassantRow, toCol);
-            std::cout << "En passant target set at: " << enPassantRow << ", " << toCol << std::endl;
-        } else {
-            clearEnPassantTarget();
+        if (type == PieceType::ROOK || type == PieceType::QUEEN) {
+            attackers |= rookAttacks(to, occupied) & straight;
         }
+        attackers &= occupied;
     }
-    
-    // FIXED: Switch player for ALL successful moves (both castling and regular)
-    switchPlayer();
-    
-    return true;
+
+    while (depth > 0) {
+        --depth;
+        gain[depth] = -std::max(-gain[depth], gain[depth + 1]);
+    }
+    return gain[0];
 }
 
-bool ChessBoard::isCheck(PieceColor color) const {
-    // Find the king
-    int kingRow = -1, kingCol = -1;
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            auto piece = board_[i][j];
-            if (piece && piece->getType() == PieceType::KING && piece->getColor() == color) {
-                kingRow = i;
-                kingCol = j;
+Bitboard ChessBoard::getHangingPieces(PieceColor color) const {
+    Bitboard hanging = 0;
+    Bitboard targets = position_.pieces(color) & ~position_.pieces(PieceType::KING);
+    while (targets) {
+        int square = popLsb(targets);
+        Bitboard attackers = attackersTo(square) & position_.pieces(oppositeColor(color));
+        while (attackers) {
+            if (see(Move(popLsb(attackers), square)) > 0) {
+                hanging |= squareBit(square);
                 break;
             }
         }
-        if (kingRow != -1) break;
     }
-    
-    if (kingRow == -1) return false;
-    
-    // Check if any opponent piece can capture the king
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            auto piece = board_[i][j];
-            if (piece && piece->getColor() != color) {
-                if (piece->isValidMove(kingRow, kingCol, board_)) {
-                    return true;
-                }
-            }
-        }
-    }
-    
-    return false;
+    return hanging;
 }
 
-bool ChessBoard::isCheckmate(PieceColor color) {
-    if (!isCheck(color)) return false;
-    
-    // Try all possible moves for all pieces of the current color
-    for (int fromRow = 0; fromRow < 8; ++fromRow) {
-        for (int fromCol = 0; fromCol < 8; ++fromCol) {
-            auto piece = board_[fromRow][fromCol];
-            if (piece && piece->getColor() == color) {
-                for (int toRow = 0; toRow < 8; ++toRow) {
-                    for (int toCol = 0; toCol < 8; ++toCol) {
-                        if (piece->isValidMove(toRow, toCol, board_)) {
-                            // Try the move
-                            auto temp = board_[toRow][toCol];
-                            board_[toRow][toCol] = piece;
-                            board_[fromRow][fromCol] = nullptr;
-                            
-                            bool stillInCheck = isCheck(color);
-                            
-                            // Undo the move
-                            board_[fromRow][fromCol] = piece;
-                            board_[toRow][toCol] = temp;
-                            
-                            if (!stillInCheck) return false;
-                        }
-                    }
-                }
-            }
-        }
+void ChessBoard::setNetwork(const NnueNetwork* network) {
+    network_ = network;
+    if (!network_) {
+        accumulators_.clear();
+        return;
     }
-    
-    return true;
+    // Earlier plies have no accumulators, so the history can't be unmade
+    // past this point; set the network before playing moves
+    accumulators_.resize(MAX_HISTORY + 1);
+    refreshAccumulator();
 }
 
-void ChessBoard::switchPlayer() {
-    currentPlayer_ = (currentPlayer_ == PieceColor::WHITE) ? PieceColor::BLACK : PieceColor::WHITE;
+int ChessBoard::evaluate() const {
+    if (network_) return network_->evaluate(accumulators_[historySize_], position_.sideToMove());
+    return ::evaluate(position_);
 }
 
-void ChessBoard::draw(sf::RenderWindow& window) const {
-    drawBoard(window);
-    drawPieces(window);  // Draw pieces BEFORE selection and valid moves
-    drawSelection(window);
-    drawValidMoves(window);
+void ChessBoard::refreshAccumulator() {
+    if (!network_) return;
+    network_->refresh(position_, PieceColor::WHITE, accumulators_[historySize_]);
+    network_->refresh(position_, PieceColor::BLACK, accumulators_[historySize_]);
 }
 
-void ChessBoard::drawBoard(sf::RenderWindow& window) const {
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            sf::RectangleShape square(sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
-            square.setPosition(sf::Vector2f(
-                BOARD_OFFSET_X + col * SQUARE_SIZE, 
-                BOARD_OFFSET_Y + row * SQUARE_SIZE
-            ));
-            square.setFillColor(getSquareColor(row, col));
-            window.draw(square);
+// A move changes at most two inputs per piece it touches: the mover leaves
+// from and arrives on to (as the promoted piece), a captured piece and a
+// castling rook leave. A king move changes the mover's own view of every
+// piece, so that side is refreshed instead.
+void ChessBoard::updateAccumulator(const UndoState& undo) {
+    const NnueAccumulator& before = accumulators_[historySize_ - 1];
+    NnueAccumulator& after = accumulators_[historySize_];
+    Move move = undo.move;
+    PieceColor us = oppositeColor(position_.sideToMove());
+    PieceColor them = position_.sideToMove();
+    PieceType moved = move.isPromotion() ? PieceType::PAWN : position_.pieceTypeAt(move.to());
+
+    for (PieceColor perspective : {PieceColor::WHITE, PieceColor::BLACK}) {
+        if (moved == PieceType::KING && perspective == us) {
+            network_->refresh(position_, perspective, after);
+            continue;
         }
-    }
-}
 
-void ChessBoard::drawPieces(sf::RenderWindow& window) const {
-    for (int row = 0; row < 8; ++row) {
-        for (int col = 0; col < 8; ++col) {
-            auto piece = board_[row][col];
-            if (piece) {
-                std::string textureName;
-                switch (piece->getType()) {
-                    case PieceType::PAWN:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_pawn" : "black_pawn";
-                        break;
-                    case PieceType::ROOK:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_rook" : "black_rook";
-                        break;
-                    case PieceType::KNIGHT:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_knight" : "black_knight";
-                        break;
-                    case PieceType::BISHOP:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_bishop" : "black_bishop";
-                        break;
-                    case PieceType::QUEEN:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_queen" : "black_queen";
-                        break;
-                    case PieceType::KING:
-                        textureName = (piece->getColor() == PieceColor::WHITE) ? "white_king" : "black_king";
-                        break;
-                    default:
-                        continue;
-                }
-                
-                auto it = textures_.find(textureName);
-                if (it != textures_.end()) {
-                    sf::Sprite sprite(it->second);
-                    
-                    // Simple positioning - FIXED for SFML3
-                    float posX = BOARD_OFFSET_X + col * SQUARE_SIZE;
-                    float posY = BOARD_OFFSET_Y + row * SQUARE_SIZE;
-                    
-                    sprite.setPosition(sf::Vector2f(posX, posY));  // FIXED: Use Vector2f
-                    window.draw(sprite);
-                }
-            }
+        int king = position_.kingSquare(perspective);
+        int added[2], removed[2];
+        int addedCount = 0, removedCount = 0;
+        if (move.isCastling()) {
+            int rookFrom = move.to() > move.from() ? move.from() + 3 : move.from() - 4;
+            int rookTo = move.to() > move.from() ? move.from() + 1 : move.from() - 1;
+            removed[removedCount++] = NnueNetwork::featureIndex(perspective, king, PieceType::ROOK, us, rookFrom);
+            added[addedCount++] = NnueNetwork::featureIndex(perspective, king, PieceType::ROOK, us, rookTo);
+        } else if (moved != PieceType::KING) {
+            removed[removedCount++] = NnueNetwork::featureIndex(perspective, king, moved, us, move.from());
+            added[addedCount++] = NnueNetwork::featureIndex(perspective, king, position_.pieceTypeAt(move.to()), us, move.to());
+        }
+        if (undo.captured != PieceType::NONE) {
+            int square = move.isEnPassant() ? (us == PieceColor::WHITE ? move.to() - 8 : move.to() + 8) : move.to();
+            removed[removedCount++] = NnueNetwork::featureIndex(perspective, king, undo.captured, them, square);
         }
+        network_->update(before, after, perspective, added, addedCount, removed, removedCount);
     }
 }
 
-void ChessBoard::drawSelection(sf::RenderWindow& window) const {
-    if (hasSelected_) {
-        sf::RectangleShape highlight(sf::Vector2f(SQUARE_SIZE, SQUARE_SIZE));
-        highlight.setPosition(sf::Vector2f(
-            BOARD_OFFSET_X + selectedCol_ * SQUARE_SIZE, 
-            BOARD_OFFSET_Y + selectedRow_ * SQUARE_SIZE
-        ));
-        highlight.setFillColor(sf::Color(255, 255, 0, 100)); // Semi-transparent yellow
-        window.draw(highlight);
+// Earlier occurrences of the current position, counting up to stopAt. Only
+// positions since the last capture or pawn move can match, and only those
+// with the same side to move, so the scan steps back two plies at a time.
+int ChessBoard::countRepetitions(int stopAt) const {
+    std::uint64_t key = position_.key();
+    int reversible = std::min(position_.halfmoveClock(), historySize_);
+    int count = 0;
+    for (int ply = 2; ply <= reversible; ply += 2) {
+        if (history_[historySize_ - ply].undo.key == key && ++count == stopAt) break;
     }
+    return count;
 }
 
-void ChessBoard::drawValidMoves(sf::RenderWindow& window) const {
-    if (hasSelected_) {
-        auto validMoves = getValidMoves(selectedRow_, selectedCol_);
-        for (const auto& move : validMoves) {
-            sf::CircleShape circle(8);
-            circle.setPosition(sf::Vector2f(
-                BOARD_OFFSET_X + move.second * SQUARE_SIZE + SQUARE_SIZE/2 - 8, 
-                BOARD_OFFSET_Y + move.first * SQUARE_SIZE + SQUARE_SIZE/2 - 8
-            ));
-            circle.setFillColor(sf::Color(0, 255, 0, 100)); // Semi-transparent green
-            window.draw(circle);
-        }
-    }
+ChessPiece ChessBoard::getPiece(int row, int col) const {
+    if (row < 0 || row >= 8 || col < 0 || col >= 8) return ChessPiece();
+    int square = makeSquare(row, col);
+    return ChessPiece(position_.pieceTypeAt(square), position_.pieceColorAt(square), row, col);
 }
 
-// ========== handleClick METHOD - CORRECTED ==========
-// FIXED: Removed switchPlayer() call to prevent double switching
-void ChessBoard::handleClick(int x, int y) {
-    int col = (x - BOARD_OFFSET_X) / SQUARE_SIZE;
-    int row = (y - BOARD_OFFSET_Y) / SQUARE_SIZE;
-    
-    if (row < 0 || row >= 8 || col < 0 || col >= 8) return;
-    
-    if (hasSelected_) {
-        if (movePiece(selectedRow_, selectedCol_, row, col)) {
-            if (isCheckmate(currentPlayer_)) {
-                std::cout << "Checkmate! " << (currentPlayer_ == PieceColor::WHITE ? "Black" : "White") << " wins!" << std::endl;
-            } else if (isCheck(currentPlayer_)) {
-                std::cout << "Check!" << std::endl;
-            }
-            // REMOVED: switchPlayer(); - Now handled in movePiece() for all moves
-        }
-        hasSelected_ = false;
-    } else {
-        auto piece = board_[row][col];
-        if (piece && piece->getColor() == currentPlayer_) {
-            selectedRow_ = row;
-            selectedCol_ = col;
-            hasSelected_ = true;
-        }
-    }
+std::pair<int, int> ChessBoard::getEnPassantTarget() const {
+    int square = position_.enPassantSquare();
+    if (square == NO_SQUARE) return {-1, -1};
+    return {squareRow(square), squareCol(square)};
 }
 
-// ========== getValidMoves METHOD - UPDATED ==========
-// CHANGES: Added en passant validation for pawn moves
-// WHY: Need to filter which diagonal pawn moves are actually valid en passant captures
-// ADDED: Castling moves for kings
-std::vector<std::pair<int, int>> ChessBoard::getValidMoves(int row, int col) const {
-    std::vector<std::pair<int, int>> moves;
-    auto piece = board_[row][col];
-    if (!piece) return moves;
-
-    // ADDED: For kings, add castling moves if available
-    if (piece->getType() == PieceType::KING) {
-        // Add normal king moves
-        for (int toRow = 0; toRow < 8; ++toRow) {
-            for (int toCol = 0; toCol < 8; ++toCol) {
-                if (piece->isValidMove(toRow, toCol, board_)) {
-                    moves.emplace_back(toRow, toCol);
-                }
-            }
-        }
-        
-        // ADD CASTLING MOVES
-        if (canCastleKingSide(piece->getColor())) {
-            int kingRow = (piece->getColor() == PieceColor::WHITE) ? 7 : 0;
-            moves.emplace_back(kingRow, 6); // Kingside castling target
-        }
-        if (canCastleQueenSide(piece->getColor())) {
-            int kingRow = (piece->getColor() == PieceColor::WHITE) ? 7 : 0;
-            moves.emplace_back(kingRow, 2); // Queenside castling target
-        }
-    }
-    // For pawns, handle en passant (existing code)
-    else if (piece->getType() == PieceType::PAWN) {
-        for (int toRow = 0; toRow < 8; ++toRow) {
-            for (int toCol = 0; toCol < 8; ++toCol) {
-                if (piece->isValidMove(toRow, toCol, board_)) {
-                    if (col != toCol && !board_[toRow][toCol]) {
-                        if (toRow == enPassantTargetRow_ && toCol == enPassantTargetCol_) {
-                            moves.emplace_back(toRow, toCol);
-                        }
-                    } else {
-                        moves.emplace_back(toRow, toCol);
-                    }
-                }
-            }
-        }
-    } else {
-        // For other pieces, use normal validation
-        for (int toRow = 0; toRow < 8; ++toRow) {
-            for (int toCol = 0; toCol < 8; ++toCol) {
-                if (piece->isValidMove(toRow, toCol, board_)) {
-                    moves.emplace_back(toRow, toCol);
-                }
-            }
+bool ChessBoard::movePiece(int fromRow, int fromCol, int toRow, int toCol) {
+    if (fromRow < 0 || fromRow >= 8 || fromCol < 0 || fromCol >= 8) return false;
+    if (toRow < 0 || toRow >= 8 || toCol < 0 || toCol >= 8) return false;
+
+    int from = makeSquare(fromRow, fromCol);
+    int to = makeSquare(toRow, toCol);
+
+    if (isHistoryFull()) return false;
+
+    // Only legal moves are accepted; a pawn reaching the last rank becomes a
+    // queen. move is a copy: makeMove invalidates the cached list.
+    for (Move move : getCachedLegalMoves()) {
+        if (move.from() != from || move.to() != to) continue;
+        if (move.isPromotion() && move.promotion() != PieceType::QUEEN) continue;
+
+        if (move.isCastling()) {
+            std::cout << (toCol > fromCol ? "Kingside castling!" : "Queenside castling!") << std::endl;
+        } else if (move.isEnPassant()) {
+            std::cout << "En passant capture! Removed pawn at " << fromRow << "," << toCol << std::endl;
         }
+
+        makeMove(move);
+        return true;
     }
+
+    return false;
+}
+
+bool ChessBoard::isCheck(PieceColor color) const {
+    int kingSquare = getKingSquare(color);
+    if (kingSquare == NO_SQUARE) return false;
     
-    return moves;
+    // Check if any opponent piece can capture the king
+    return isSquareUnderAttack(squareRow(kingSquare), squareCol(kingSquare), color);
 }
 
-// ADDED: Castling validation and execution methods
+bool ChessBoard::isCheckmate(PieceColor color) const {
+    // Only the side to move can be mated
+    return color == position_.sideToMove() && getStatus() == GameStatus::CHECKMATE;
+}
 
-bool ChessBoard::canCastleKingSide(PieceColor color) const {
-    int kingRow = (color == PieceColor::WHITE) ? 7 : 0;
-    
-    // Check if king has moved
-    if ((color == PieceColor::WHITE && whiteKingMoved_) ||
-        (color == PieceColor::BLACK && blackKingMoved_)) {
-        return false;
-    }
-    
-    // Check if kingside rook has moved
-    if ((color == PieceColor::WHITE && whiteRookKingSideMoved_) ||
-        (color == PieceColor::BLACK && blackRookKingSideMoved_)) {
-        return false;
-    }
-    
-    // Check if squares between king and rook are empty
-    if (board_[kingRow][5] || board_[kingRow][6]) {
-        return false;
-    }
-    
-    // Check if king is in check
-    if (isCheck(color)) {
-        return false;
-    }
-    
-    // Check if king passes through or lands on attacked squares
-    if (isSquareUnderAttack(kingRow, 4, color) ||  // King's original position
-        isSquareUnderAttack(kingRow, 5, color) ||  // Square king passes through
-        isSquareUnderAttack(kingRow, 6, color)) {  // Square king lands on
-        return false;
-    }
-    
-    return true;
+bool ChessBoard::isStalemate(PieceColor color) const {
+    return color == position_.sideToMove() && getStatus() == GameStatus::STALEMATE;
 }
 
-bool ChessBoard::canCastleQueenSide(PieceColor color) const {
-    int kingRow = (color == PieceColor::WHITE) ? 7 : 0;
-    
-    // Check if king has moved
-    if ((color == PieceColor::WHITE && whiteKingMoved_) ||
-        (color == PieceColor::BLACK && blackKingMoved_)) {
-        return false;
-    }
-    
-    // Check if queenside rook has moved
-    if ((color == PieceColor::WHITE && whiteRookQueenSideMoved_) ||
-        (color == PieceColor::BLACK && blackRookQueenSideMoved_)) {
-        return false;
-    }
-    
-    // Check if squares between king and rook are empty
-    if (board_[kingRow][1] || board_[kingRow][2] || board_[kingRow][3]) {
-        return false;
-    }
-    
-    // Check if king is in check
-    if (isCheck(color)) {
-        return false;
-    }
-    
-    // Check if king passes through or lands on attacked squares
-    if (isSquareUnderAttack(kingRow, 4, color) ||  // King's original position
-        isSquareUnderAttack(kingRow, 3, color) ||  // Square king passes through
-        isSquareUnderAttack(kingRow, 2, color)) {  // Square king lands on
-        return false;
+void ChessBoard::getLegalMoves(MoveList& moves) const {
+    generateLegalMoves(position_, moves, attacks_[colorIndex(oppositeColor(position_.sideToMove()))]);
+}
+
+const MoveList& ChessBoard::getCachedLegalMoves() const {
+    if (!legalMovesValid_) {
+        getLegalMoves(legalMoves_);
+        bool inCheck = isCheck(position_.sideToMove());
+        status_ = legalMoves_.empty() ? (inCheck ? GameStatus::CHECKMATE : GameStatus::STALEMATE)
+                                      : (inCheck ? GameStatus::CHECK : GameStatus::NORMAL);
+        legalMovesValid_ = true;
     }
-    
-    return true;
+    return legalMoves_;
 }
 
-void ChessBoard::performCastleKingSide(PieceColor color) {
-    int kingRow = (color == PieceColor::WHITE) ? 7 : 0;
-    
-    // Move king
-    auto king = board_[kingRow][4];
-    board_[kingRow][4] = nullptr;
-    board_[kingRow][6] = king;
-    king->setPosition(kingRow, 6);
-    king->setMoved(true);
-    
-    // Move rook
-    auto rook = board_[kingRow][7];
-    board_[kingRow][7] = nullptr;
-    board_[kingRow][5] = rook;
-    rook->setPosition(kingRow, 5);
-    rook->setMoved(true);
+GameStatus ChessBoard::getStatus() const {
+    getCachedLegalMoves();
+    return status_;
 }
 
-void ChessBoard::performCastleQueenSide(PieceColor color) {
-    int kingRow = (color == PieceColor::WHITE) ? 7 : 0;
-    
-    // Move king
-    auto king = board_[kingRow][4];
-    board_[kingRow][4] = nullptr;
-    board_[kingRow][2] = king;
-    king->setPosition(kingRow, 2);
-    king->setMoved(true);
-    
-    // Move rook
-    auto rook = board_[kingRow][0];
-    board_[kingRow][0] = nullptr;
-    board_[kingRow][3] = rook;
-    rook->setPosition(kingRow, 3);
-    rook->setMoved(true);
+void ChessBoard::getLegalCaptures(MoveList& moves) const {
+    generateLegalCaptures(position_, moves, attacks_[colorIndex(oppositeColor(position_.sideToMove()))]);
 }
 
-bool ChessBoard::isSquareUnderAttack(int row, int col, PieceColor defenderColor) const {
-    // Check if any opponent piece can attack this square
-    for (int i = 0; i < 8; ++i) {
-        for (int j = 0; j < 8; ++j) {
-            auto piece = board_[i][j];
-            if (piece && piece->getColor() != defenderColor) {
-                if (piece->isValidMove(row, col, board_)) {
-                    return true;
-                }
-            }
+// Legal moves of the piece on (row, col). Only the side to move has any.
+// A promotion is listed once, as a queen, since the GUI promotes to queens.
+MoveList ChessBoard::getValidMoves(int row, int col) const {
+    MoveList moves;
+    if (row < 0 || row >= 8 || col < 0 || col >= 8) return moves;
+
+    int from = makeSquare(row, col);
+    if (position_.pieceColorAt(from) != position_.sideToMove()) return moves;
+
+    for (Move move : getCachedLegalMoves()) {
+        if (move.from() == from && (!move.isPromotion() || move.promotion() == PieceType::QUEEN)) {
+            moves.add(move);
         }
     }
-    return false;
+    
+    return moves;
 }
 
-sf::Color ChessBoard::getSquareColor(int row, int col) const {
-    return (row + col) % 2 == 0 ? sf::Color(240, 217, 181) : sf::Color(181, 136, 99);
-}
\ No newline at end of file
+bool ChessBoard::isSquareUnderAttack(int row, int col, PieceColor defenderColor) const {
+    return (getAttackedSquares(oppositeColor(defenderColor)) & squareBit(makeSquare(row, col))) != 0;
+}
@@ -2,71 +2,131 @@
 #define CHESSBOARD_H
 
 #include "ChessPiece.h"
-#include <SFML/Graphics.hpp>
-#include <memory>
-#include <unordered_map>
+#include "Nnue.h"
+#include "Position.h"
+#include <cstdint>
+#include <string>
+#include <utility>
 #include <vector>
 
+// State of the game for the side to move
+enum class GameStatus { NORMAL, CHECK, CHECKMATE, STALEMATE };
+
+// Game rules and state. Has no graphics dependency; BoardView draws it.
 class ChessBoard {
 public:
     ChessBoard();
     ~ChessBoard();
 
     void initializeBoard();
-    bool loadTextures();
-    bool loadFont();
-    std::shared_ptr<ChessPiece> getPiece(int row, int col) const;
+    // Replace the game state with the given position and clear the history
+    void setPosition(const Position& position);
+    // Forsyth-Edwards Notation; setFen leaves the board unchanged and
+    // returns false if the string is malformed
+    bool setFen(const std::string& fen);
+    std::string getFen() const { return position_.toFen(); }
+    ChessPiece getPiece(int row, int col) const;
+    const Position& getPosition() const { return position_; }
+    PieceColor getCurrentPlayer() const { return position_.sideToMove(); }
     bool movePiece(int fromRow, int fromCol, int toRow, int toCol);
     bool isCheck(PieceColor color) const;
-    bool isCheckmate(PieceColor color);
-    void switchPlayer();
-    void draw(sf::RenderWindow& window) const;
-    void handleClick(int x, int y);
-    std::vector<std::pair<int, int>> getValidMoves(int row, int col) const;
+    bool isCheckmate(PieceColor color) const;
+    bool isStalemate(PieceColor color) const;
+    MoveList getValidMoves(int row, int col) const;
+    // Every legal move for the side to move
+    void getLegalMoves(MoveList& moves) const;
+    // The same moves, generated once per position and kept until the
+    // position changes; for the UI and other repeated queries. Const calls
+    // fill the cache, so a board read by several threads needs a lock.
+    const MoveList& getCachedLegalMoves() const;
+    // Check, checkmate or stalemate, found in the same pass
+    GameStatus getStatus() const;
+    // Legal captures and promotions for the side to move
+    void getLegalCaptures(MoveList& moves) const;
+
+    // Reversible move path for search and analysis: no allocation and no
+    // output. The move must be legal in the current position.
+    void makeMove(const Move& move);
+    void unmakeMove();
+    int getHistorySize() const { return historySize_; }
+    // Leaf nodes of the legal move tree to the given depth
+    std::uint64_t perft(int depth);
+    bool isHistoryFull() const { return historySize_ == MAX_HISTORY; }
+
+    // Squares attacked by each side and king squares, kept up to date by the
+    // move path so check and attack queries are single lookups
+    Bitboard getAttackedSquares(PieceColor color) const { return attacks_[colorIndex(color)]; }
+    int getKingSquare(PieceColor color) const { return kingSquares_[colorIndex(color)]; }
+    // Pieces of both colors attacking square
+    Bitboard attackersTo(int square) const { return position_.attackersTo(square, position_.occupied()); }
+
+    // Static exchange evaluation: centipawns the mover of move wins (or
+    // loses, if negative) when both sides then keep recapturing on its
+    // target square with their least valuable piece, each free to stop.
+    // Sliders behind the pieces that leave join in; pins are ignored.
+    // Move must be pseudo-legal for the color on its from square, which
+    // need not be the side to move.
+    int see(const Move& move) const;
+    // Pieces of color the other side can win material from with a capture
+    Bitboard getHangingPieces(PieceColor color) const;
+
+    // Zobrist key of the current position
+    std::uint64_t getKey() const { return position_.key(); }
+    // The current position already occurred earlier in the game
+    bool isRepetition() const { return countRepetitions(1) >= 1; }
+    // The current position has now occurred three times
+    bool isThreefoldRepetition() const { return countRepetitions(2) >= 2; }
+
+    // Evaluation network, or nullptr for the hand-written evaluation. With a
+    // network set the board keeps one accumulator per ply, which the move
+    // path updates incrementally; the network must outlive the board.
+    void setNetwork(const NnueNetwork* network);
+    const NnueNetwork* getNetwork() const { return network_; }
+    const NnueAccumulator& getAccumulator() const { return accumulators_[historySize_]; }
+    // Centipawns for the side to move, from the network if one is set
+    int evaluate() const;
 
     // En passant methods
-    void setEnPassantTarget(int row, int col) { enPassantTargetRow_ = row; enPassantTargetCol_ = col; }
-    std::pair<int, int> getEnPassantTarget() const { return {enPassantTargetRow_, enPassantTargetCol_}; }
-    void clearEnPassantTarget() { enPassantTargetRow_ = -1; enPassantTargetCol_ = -1; }
+    void setEnPassantTarget(int row, int col) {
+        position_.setEnPassantSquare(makeSquare(row, col));
+        legalMovesValid_ = false;
+    }
+    std::pair<int, int> getEnPassantTarget() const;
+    void clearEnPassantTarget() {
+        position_.setEnPassantSquare(NO_SQUARE);
+        legalMovesValid_ = false;
+    }
+
+    static const int MAX_HISTORY = 2048;
 
 private:
-    static const int SQUARE_SIZE = 80;
-    static const int BOARD_OFFSET_X = 50;
-    static const int BOARD_OFFSET_Y = 50;
-
-    std::shared_ptr<ChessPiece> board_[8][8];
-    PieceColor currentPlayer_;
-    int selectedRow_;
-    int selectedCol_;
-    bool hasSelected_;
-    std::unordered_map<std::string, sf::Texture> textures_;
-    sf::Font font_;
-
-    // En passant tracking
-    int enPassantTargetRow_;
-    int enPassantTargetCol_;
-
-    // ADDED: Castling tracking
-    bool whiteKingMoved_;
-    bool blackKingMoved_;
-    bool whiteRookKingSideMoved_;
-    bool whiteRookQueenSideMoved_;
-    bool blackRookKingSideMoved_;
-    bool blackRookQueenSideMoved_;
-
-    bool loadTexture(const std::string& name, const std::string& filename);
-    void drawBoard(sf::RenderWindow& window) const;
-    void drawPieces(sf::RenderWindow& window) const;
-    void drawSelection(sf::RenderWindow& window) const;
-    void drawValidMoves(sf::RenderWindow& window) const;
-    sf::Color getSquareColor(int row, int col) const;
-
-    // ADDED: Castling methods
-    bool canCastleKingSide(PieceColor color) const;
-    bool canCastleQueenSide(PieceColor color) const;
-    void performCastleKingSide(PieceColor color);
-    void performCastleQueenSide(PieceColor color);
+    // Undo data plus the attack maps of the position before the move, so
+    // unmakeMove restores them instead of recomputing
+    struct HistoryEntry {
+        UndoState undo;
+        Bitboard attacks[2];
+    };
+
+    Position position_;
+    Bitboard attacks_[2];
+    int kingSquares_[2];
+    HistoryEntry history_[MAX_HISTORY];
+    int historySize_;
+    const NnueNetwork* network_;
+    std::vector<NnueAccumulator> accumulators_;     // MAX_HISTORY + 1 when network_ is set
+
+    // Legal moves and status of the current position; every edit of
+    // position_ clears legalMovesValid_
+    mutable MoveList legalMoves_;
+    mutable GameStatus status_;
+    mutable bool legalMovesValid_;
+
+    void updateAttacks();
+    void refreshAccumulator();
+    void updateAccumulator(const UndoState& undo);
+    int countRepetitions(int stopAt) const;
+
     bool isSquareUnderAttack(int row, int col, PieceColor defenderColor) const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,9 +1,14 @@
 #include "ChessPiece.h"
+#include "Position.h"
+#include "Attacks.h"
 #include <cmath>
 #include <cctype>
 
+ChessPiece::ChessPiece()
+    : type_(PieceType::NONE), color_(PieceColor::NONE), row_(-1), col_(-1) {}
+
 ChessPiece::ChessPiece(PieceType type, PieceColor color, int row, int col)
-    : type_(type), color_(color), row_(row), col_(col), hasMoved_(false) {}
+    : type_(type), color_(color), row_(row), col_(col) {}
 
 char ChessPiece::getSymbol() const {
     if (type_ == PieceType::NONE) return '.';
@@ -34,46 +39,44 @@ std::string ChessPiece::getName() const {
     }
 }
 
-bool ChessPiece::isValidMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
+bool ChessPiece::isValidMove(int toRow, int toCol, const Position& position) const {
     if (type_ == PieceType::NONE) return false;
     if (toRow == row_ && toCol == col_) return false;
     if (toRow < 0 || toRow >= 8 || toCol < 0 || toCol >= 8) return false;
     
     // Check if target square has our own piece
-    auto targetPiece = board[toRow][toCol];
-    if (targetPiece && targetPiece->getColor() == color_) {
+    if (position.pieceColorAt(makeSquare(toRow, toCol)) == color_) {
         return false;
     }
     
-    switch(type_) {
-        case PieceType::PAWN: return isValidPawnMove(toRow, toCol, board);
-        case PieceType::ROOK: return isValidRookMove(toRow, toCol, board);
-        case PieceType::KNIGHT: return isValidKnightMove(toRow, toCol);
-        case PieceType::BISHOP: return isValidBishopMove(toRow, toCol, board);
-        case PieceType::QUEEN: return isValidQueenMove(toRow, toCol, board);
-        case PieceType::KING: return isValidKingMove(toRow, toCol);
-        default: return false;
+    if (type_ == PieceType::PAWN) {
+        return isValidPawnMove(toRow, toCol, position);
     }
+    
+    // Every other piece moves to exactly the squares it attacks
+    Bitboard attacks = pieceAttacks(type_, colorIndex(color_), makeSquare(row_, col_), position.occupied());
+    return (attacks & squareBit(makeSquare(toRow, toCol))) != 0;
 }
 
-bool ChessPiece::isValidPawnMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
+bool ChessPiece::isValidPawnMove(int toRow, int toCol, const Position& position) const {
     int direction = (color_ == PieceColor::WHITE) ? -1 : 1;
     int rowDiff = toRow - row_;
     int colDiff = toCol - col_;
     
-    auto targetPiece = board[toRow][toCol];
+    PieceColor targetColor = position.pieceColorAt(makeSquare(toRow, toCol));
     
     // Forward move
     if (colDiff == 0) {
         // Single move forward
-        if (rowDiff == direction && !targetPiece) {
+        if (rowDiff == direction && targetColor == PieceColor::NONE) {
             return true;
         }
         // Double move from starting position
-        if (!hasMoved_ && rowDiff == 2 * direction && !targetPiece) {
+        int startRow = (color_ == PieceColor::WHITE) ? 6 : 1;
+        if (row_ == startRow && rowDiff == 2 * direction && targetColor == PieceColor::NONE) {
             // Check if the square in between is empty
             int middleRow = row_ + direction;
-            if (!board[middleRow][col_]) {
+            if (position.isEmpty(makeSquare(middleRow, col_))) {
                 return true;
             }
         }
@@ -81,103 +84,15 @@ bool ChessPiece::isValidPawnMove(int toRow, int toCol, const std::shared_ptr<Che
     // Capture move (diagonal) - INCLUDING EN PASSANT
     else if (std::abs(colDiff) == 1 && rowDiff == direction) {
         // Regular capture OR en passant (en passant validation happens in ChessBoard)
-        if (targetPiece && targetPiece->getColor() != color_) {
+        if (targetColor != PieceColor::NONE && targetColor != color_) {
             return true;  // Regular capture
         }
         // For en passant: allow diagonal move to empty square
         // ChessBoard will validate if it's actually an en passant situation
-        if (!targetPiece) {
+        if (targetColor == PieceColor::NONE) {
             return true;  // Potential en passant (validated by ChessBoard)
         }
     }
     
     return false;
 }
-
-bool ChessPiece::isValidRookMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
-    int rowDiff = toRow - row_;
-    int colDiff = toCol - col_;
-    
-    // Rook moves horizontally or vertically
-    if (rowDiff != 0 && colDiff != 0) {
-        return false;
-    }
-    
-    return isPathClear(toRow, toCol, board);
-}
-
-bool ChessPiece::isValidKnightMove(int toRow, int toCol) const {
-    int rowDiff = std::abs(toRow - row_);
-    int colDiff = std::abs(toCol - col_);
-    
-    // Knight moves in L-shape: 2 in one direction, 1 in perpendicular
-    return (rowDiff == 2 && colDiff == 1) || (rowDiff == 1 && colDiff == 2);
-}
-
-bool ChessPiece::isValidBishopMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
-    int rowDiff = toRow - row_;
-    int colDiff = toCol - col_;
-    
-    // Bishop moves diagonally
-    if (std::abs(rowDiff) != std::abs(colDiff)) {
-        return false;
-    }
-    
-    return isPathClear(toRow, toCol, board);
-}
-
-bool ChessPiece::isValidQueenMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
-    int rowDiff = toRow - row_;
-    int colDiff = toCol - col_;
-    
-    // Queen moves like rook or bishop
-    bool isRookMove = (rowDiff == 0 || colDiff == 0);
-    bool isBishopMove = (std::abs(rowDiff) == std::abs(colDiff));
-    
-    if (!isRookMove && !isBishopMove) {
-        return false;
-    }
-    
-    return isPathClear(toRow, toCol, board);
-}
-
-// ========== ONLY CHANGE THIS METHOD ==========
-// CHANGES: Allow king to move two squares horizontally for castling
-// WHY: Castling requires the king to move two squares toward the rook
-bool ChessPiece::isValidKingMove(int toRow, int toCol) const {
-    int rowDiff = std::abs(toRow - row_);
-    int colDiff = std::abs(toCol - col_);
-    
-    // ADDED: Allow king to move two squares horizontally for castling
-    // The ChessBoard class will validate if it's actually a valid castling situation
-    if (rowDiff == 0 && colDiff == 2) {
-        return true; // Potential castling (validated by ChessBoard)
-    }
-    
-    // King moves one square in any direction
-    return rowDiff <= 1 && colDiff <= 1;
-}
-
-bool ChessPiece::isPathClear(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const {
-    int rowStep = 0, colStep = 0;
-    
-    if (toRow > row_) rowStep = 1;
-    else if (toRow < row_) rowStep = -1;
-    
-    if (toCol > col_) colStep = 1;
-    else if (toCol < col_) colStep = -1;
-    
-    int currentRow = row_ + rowStep;
-    int currentCol = col_ + colStep;
-    
-    // Check all squares between current position and target (excluding target)
-    while (currentRow != toRow || currentCol != toCol) {
-        if (board[currentRow][currentCol]) {
-            return false; // Path is blocked
-        }
-        currentRow += rowStep;
-        currentCol += colStep;
-    }
-    
-    return true;
-}
\ No newline at end of file
@@ -1,6 +1,5 @@
 #pragma once
 #include <string>
-#include <memory>
 
 enum class PieceType {
     NONE = 0,
@@ -18,35 +17,31 @@ enum class PieceColor {
     BLACK
 };
 
+class Position;
+
+// Lightweight view of one square for the GUI. The board's Position is the
+// source of truth; a ChessPiece is built on demand and never stored.
 class ChessPiece {
 public:
+    ChessPiece();
     ChessPiece(PieceType type, PieceColor color, int row, int col);
     
+    bool isEmpty() const { return type_ == PieceType::NONE; }
+
     PieceType getType() const { return type_; }
     PieceColor getColor() const { return color_; }
     int getRow() const { return row_; }
     int getCol() const { return col_; }
-    void setPosition(int row, int col) { row_ = row; col_ = col; }
-    bool hasMoved() const { return hasMoved_; }
-    void setMoved(bool moved) { hasMoved_ = moved; }
     
     char getSymbol() const;
     std::string getName() const;
-    bool isValidMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
+    bool isValidMove(int toRow, int toCol, const Position& position) const;
     
 private:
-    bool isValidPawnMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
-    bool isValidRookMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
-    bool isValidKnightMove(int toRow, int toCol) const;
-    bool isValidBishopMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
-    bool isValidQueenMove(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
-    bool isValidKingMove(int toRow, int toCol) const;
-    
-    bool isPathClear(int toRow, int toCol, const std::shared_ptr<ChessPiece> board[8][8]) const;
+    bool isValidPawnMove(int toRow, int toCol, const Position& position) const;
     
     PieceType type_;
     PieceColor color_;
     int row_;
     int col_;
-    bool hasMoved_;
 };
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef ENDIAN_H
+#define ENDIAN_H
+
+#include <cstdint>
+
+// Fixed byte order for the binary files (game database, position index,
+// networks, endgame tables, Polyglot books), whatever the host's order.
+// bytes is 1 to 8.
+
+inline void putLe(unsigned char* out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) out[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+inline std::uint64_t getLe(const unsigned char* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= static_cast<std::uint64_t>(in[i]) << (8 * i);
+    return value;
+}
+
+inline std::uint64_t getBe(const unsigned char* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value = (value << 8) | in[i];
+    return value;
+}
+
+#endif
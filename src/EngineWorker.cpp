@@ -0,0 +1,93 @@
+#include "EngineWorker.h"
+
+EngineWorker::EngineWorker(int threads, std::size_t hashMegabytes)
+    : table_(hashMegabytes), search_(table_, threads), board_(new ChessBoard()), nextId_(0),
+      cancelledId_(0), runningId_(0), middle_(1), back_(0), front_(2) {
+    // Ends the current iteration once its go has been cancelled, which
+    // also covers a stop that arrived just before the search started
+    search_.setInfoCallback([this](const SearchResult&) {
+        if (runningId_.load() <= cancelledId_.load()) search_.stop();
+    });
+    thread_ = std::thread(&EngineWorker::loop, this);
+}
+
+EngineWorker::~EngineWorker() {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(Command{CommandType::QUIT, nullptr, SearchLimits(), 0});
+    }
+    commandReady_.notify_one();
+    thread_.join();
+}
+
+void EngineWorker::setPosition(const ChessBoard& board) {
+    std::unique_ptr<ChessBoard> copy(new ChessBoard(board));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(Command{CommandType::POSITION, std::move(copy), SearchLimits(), 0});
+    }
+    commandReady_.notify_one();
+}
+
+unsigned EngineWorker::go(const SearchLimits& limits) {
+    unsigned id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = ++nextId_;
+        commands_.push_back(Command{CommandType::GO, nullptr, limits, id});
+    }
+    commandReady_.notify_one();
+    return id;
+}
+
+void EngineWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cancelledId_ = nextId_;
+    }
+    if (runningId_.load() != 0) search_.stop();
+}
+
+bool EngineWorker::pollResult(SearchResult& result, unsigned& id) {
+    if (!(middle_.load(std::memory_order_relaxed) & DIRTY)) return false;
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~DIRTY;
+    result = slots_[front_].result;
+    id = slots_[front_].id;
+    return true;
+}
+
+void EngineWorker::publish(const SearchResult& result, unsigned id) {
+    slots_[back_].result = result;
+    slots_[back_].id = id;
+    back_ = middle_.exchange(back_ | DIRTY, std::memory_order_acq_rel) & ~DIRTY;
+}
+
+void EngineWorker::loop() {
+    for (;;) {
+        Command command;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            commandReady_.wait(lock, [this] { return !commands_.empty(); });
+            command = std::move(commands_.front());
+            commands_.pop_front();
+        }
+
+        switch (command.type) {
+            case CommandType::QUIT:
+                return;
+            case CommandType::POSITION:
+                board_ = std::move(command.board);
+                break;
+            case CommandType::GO: {
+                if (command.id <= cancelledId_.load()) break;
+                search_.clearStop();
+                runningId_ = command.id;
+                SearchResult result = search_.run(*board_, command.limits);
+                runningId_ = 0;
+                if (command.id > cancelledId_.load()) publish(result, command.id);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef ENGINEWORKER_H
+#define ENGINEWORKER_H
+
+#include "ParallelSearch.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Runs searches on a dedicated thread so the caller never blocks on
+// thinking. Commands (position, go) go through a mutex-protected queue
+// and are executed in order; results come back through a lock-free
+// mailbox that the caller polls, e.g. once per frame.
+class EngineWorker {
+public:
+    EngineWorker(int threads, std::size_t hashMegabytes);
+    ~EngineWorker();
+
+    EngineWorker(const EngineWorker&) = delete;
+    EngineWorker& operator=(const EngineWorker&) = delete;
+
+    // Position for the following go commands; the board is copied
+    void setPosition(const ChessBoard& board);
+    // Queues a search and returns the id its result will carry
+    unsigned go(const SearchLimits& limits);
+    // Cancels the running search, mid-iteration, and any queued ones.
+    // Their results are dropped, so the next result is from a later go.
+    void stop();
+
+    // Takes the newest finished result, if any; never blocks
+    bool pollResult(SearchResult& result, unsigned& id);
+
+private:
+    enum class CommandType { POSITION, GO, QUIT };
+
+    struct Command {
+        CommandType type;
+        std::unique_ptr<ChessBoard> board;
+        SearchLimits limits;
+        unsigned id;
+    };
+
+    void loop();
+    void publish(const SearchResult& result, unsigned id);
+
+    // Owned by the worker thread once started
+    TranspositionTable table_;
+    ParallelSearch search_;
+    std::unique_ptr<ChessBoard> board_;
+
+    std::mutex mutex_;
+    std::condition_variable commandReady_;
+    std::deque<Command> commands_;
+    unsigned nextId_;                       // guarded by mutex_
+    std::atomic<unsigned> cancelledId_;     // go commands up to this id are cancelled
+    std::atomic<unsigned> runningId_;       // 0 when idle
+
+    // Triple buffer: the worker fills slots_[back_], then swaps it with the
+    // middle slot and sets the dirty bit; pollResult swaps the middle slot
+    // with front_ when the bit is set. Neither side ever waits.
+    struct Mailbox {
+        SearchResult result;
+        unsigned id;
+    };
+    static const int DIRTY = 4;
+    Mailbox slots_[3];
+    std::atomic<int> middle_;
+    int back_;      // worker thread only
+    int front_;     // polling thread only
+
+    std::thread thread_;
+};
+
+#endif
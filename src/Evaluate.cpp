@@ -0,0 +1,135 @@
+#include "Evaluate.h"
+
+namespace {
+
+// Indexed by PieceType
+const int PIECE_VALUES[7] = {0, 100, 500, 320, 330, 900, 0};
+
+// Piece-square tables from white's point of view, rank 8 first, so a white
+// piece on square s reads entry s ^ 56 and a black piece reads entry s
+const int PAWN_TABLE[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+     50,  50,  50,  50,  50,  50,  50,  50,
+     10,  10,  20,  30,  30,  20,  10,  10,
+      5,   5,  10,  25,  25,  10,   5,   5,
+      0,   0,   0,  20,  20,   0,   0,   0,
+      5,  -5, -10,   0,   0, -10,  -5,   5,
+      5,  10,  10, -20, -20,  10,  10,   5,
+      0,   0,   0,   0,   0,   0,   0,   0
+};
+
+const int KNIGHT_TABLE[64] = {
+    -50, -40, -30, -30, -30, -30, -40, -50,
+    -40, -20,   0,   0,   0,   0, -20, -40,
+    -30,   0,  10,  15,  15,  10,   0, -30,
+    -30,   5,  15,  20,  20,  15,   5, -30,
+    -30,   0,  15,  20,  20,  15,   0, -30,
+    -30,   5,  10,  15,  15,  10,   5, -30,
+    -40, -20,   0,   5,   5,   0, -20, -40,
+    -50, -40, -30, -30, -30, -30, -40, -50
+};
+
+const int BISHOP_TABLE[64] = {
+    -20, -10, -10, -10, -10, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,  10,  10,   5,   0, -10,
+    -10,   5,   5,  10,  10,   5,   5, -10,
+    -10,   0,  10,  10,  10,  10,   0, -10,
+    -10,  10,  10,  10,  10,  10,  10, -10,
+    -10,   5,   0,   0,   0,   0,   5, -10,
+    -20, -10, -10, -10, -10, -10, -10, -20
+};
+
+const int ROOK_TABLE[64] = {
+      0,   0,   0,   0,   0,   0,   0,   0,
+      5,  10,  10,  10,  10,  10,  10,   5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+     -5,   0,   0,   0,   0,   0,   0,  -5,
+      0,   0,   0,   5,   5,   0,   0,   0
+};
+
+const int QUEEN_TABLE[64] = {
+    -20, -10, -10,  -5,  -5, -10, -10, -20,
+    -10,   0,   0,   0,   0,   0,   0, -10,
+    -10,   0,   5,   5,   5,   5,   0, -10,
+     -5,   0,   5,   5,   5,   5,   0,  -5,
+      0,   0,   5,   5,   5,   5,   0,  -5,
+    -10,   5,   5,   5,   5,   5,   0, -10,
+    -10,   0,   5,   0,   0,   0,   0, -10,
+    -20, -10, -10,  -5,  -5, -10, -10, -20
+};
+
+const int KING_MIDDLEGAME_TABLE[64] = {
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -30, -40, -40, -50, -50, -40, -40, -30,
+    -20, -30, -30, -40, -40, -30, -30, -20,
+    -10, -20, -20, -20, -20, -20, -20, -10,
+     20,  20,   0,   0,   0,   0,  20,  20,
+     20,  30,  10,   0,   0,  10,  30,  20
+};
+
+const int KING_ENDGAME_TABLE[64] = {
+    -50, -40, -30, -20, -20, -30, -40, -50,
+    -30, -20, -10,   0,   0, -10, -20, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  30,  40,  40,  30, -10, -30,
+    -30, -10,  20,  30,  30,  20, -10, -30,
+    -30, -30,   0,   0,   0,   0, -30, -30,
+    -50, -30, -30, -30, -30, -30, -30, -50
+};
+
+// Indexed by PieceType; the king is handled separately
+const int* const PIECE_TABLES[7] = {nullptr, PAWN_TABLE, ROOK_TABLE, KNIGHT_TABLE, BISHOP_TABLE, QUEEN_TABLE, nullptr};
+
+// Game phase weights: 24 with all minor and major pieces on the board
+const int PHASE_WEIGHTS[7] = {0, 0, 2, 1, 1, 4, 0};
+const int MAX_PHASE = 24;
+
+} // namespace
+
+int pieceValue(PieceType type) {
+    return PIECE_VALUES[static_cast<int>(type)];
+}
+
+int pieceSquareValue(PieceType type, PieceColor color, int square) {
+    const int* table = PIECE_TABLES[static_cast<int>(type)];
+    return PIECE_VALUES[static_cast<int>(type)] + table[color == PieceColor::WHITE ? square ^ 56 : square];
+}
+
+int evaluate(const Position& position) {
+    const PieceType types[5] = {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+
+    int score = 0;      // white minus black
+    int phase = 0;
+    for (PieceType type : types) {
+        const int* table = PIECE_TABLES[static_cast<int>(type)];
+        int value = PIECE_VALUES[static_cast<int>(type)];
+
+        Bitboard white = position.pieces(type, PieceColor::WHITE);
+        Bitboard black = position.pieces(type, PieceColor::BLACK);
+        phase += PHASE_WEIGHTS[static_cast<int>(type)] * popCount(white | black);
+        score += value * (popCount(white) - popCount(black));
+        while (white) score += table[popLsb(white) ^ 56];
+        while (black) score -= table[popLsb(black)];
+    }
+
+    if (phase > MAX_PHASE) phase = MAX_PHASE;
+    int whiteKing = position.kingSquare(PieceColor::WHITE);
+    int blackKing = position.kingSquare(PieceColor::BLACK);
+    if (whiteKing != NO_SQUARE) {
+        score += (KING_MIDDLEGAME_TABLE[whiteKing ^ 56] * phase +
+                  KING_ENDGAME_TABLE[whiteKing ^ 56] * (MAX_PHASE - phase)) / MAX_PHASE;
+    }
+    if (blackKing != NO_SQUARE) {
+        score -= (KING_MIDDLEGAME_TABLE[blackKing] * phase +
+                  KING_ENDGAME_TABLE[blackKing] * (MAX_PHASE - phase)) / MAX_PHASE;
+    }
+
+    return position.sideToMove() == PieceColor::WHITE ? score : -score;
+}
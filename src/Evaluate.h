@@ -0,0 +1,17 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "Position.h"
+
+// Material value of a piece in centipawns (the king counts as 0)
+int pieceValue(PieceType type);
+// Material plus piece-square entry of a pawn to queen of color on square,
+// counted for that color
+int pieceSquareValue(PieceType type, PieceColor color, int square);
+
+// Static evaluation: material plus piece-square tables, with the king table
+// blended from middlegame to endgame as pieces come off. In centipawns from
+// the side to move's point of view.
+int evaluate(const Position& position);
+
+#endif
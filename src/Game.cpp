@@ -1,9 +1,15 @@
 #include "Game.h"
 #include <SFML/Window/Mouse.hpp>
 #include <SFML/Window/Keyboard.hpp>
+#include <algorithm>
 #include <iostream>
+#include <thread>
 
-Game::Game() : window_(nullptr), board_(nullptr) {}
+Game::Game()
+    : window_(nullptr), board_(nullptr), view_(nullptr), engine_(nullptr), book_(nullptr),
+      random_(std::random_device()()), tablebases_(nullptr), titlePly_(-1),
+      computerColor_(PieceColor::NONE), pendingSearch_(0), needsRedraw_(true), frameKey_(0), framePly_(-1),
+      framesRendered_(0), framesSkipped_(0) {}
 
 Game::~Game() {
     cleanup();  // Destructor calls cleanup
@@ -17,11 +23,46 @@ bool Game::initialize() {
         return false;
     }
     
+    // Capped so the UI thread leaves the remaining cores to the engine
+    window_->setFramerateLimit(FRAME_RATE_LIMIT);
+    
     board_ = new ChessBoard();
+    view_ = new BoardView(*board_);
+
+    if (!tablebasePath_.empty()) {
+        tablebases_ = new Tablebases();
+        int tables = tablebases_->load(tablebasePath_);
+        std::cout << tables << " endgame tables loaded from " << tablebasePath_ << std::endl;
+        if (tables == 0) {
+            delete tablebases_;
+            tablebases_ = nullptr;
+        }
+        view_->setTablebases(tablebases_);
+    }
+
+    if (computerColor_ != PieceColor::NONE) {
+        // One core stays with the UI thread
+        int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        engine_ = new EngineWorker(threads, 64);
+
+        if (!bookPath_.empty()) {
+            book_ = new PolyglotBook();
+            if (!book_->open(bookPath_)) {
+                if (!book_->hasKeys()) {
+                    std::cout << PolyglotBook::keysPath(bookPath_)
+                              << " is missing or not the Polyglot Random64 table, playing without book" << std::endl;
+                } else {
+                    std::cout << "Cannot open book " << bookPath_ << ", playing without book" << std::endl;
+                }
+                delete book_;
+                book_ = nullptr;
+            }
+        }
+    }
     
     // Try to load textures
-    if (!board_->loadTextures()) {
-        std::cout << "Some textures failed to load, using fallback rendering" << std::endl;
+    if (!view_->loadTextures()) {
+        std::cout << "Some textures failed to load, pieces without one are drawn as plain tokens" << std::endl;
     } else {
         std::cout << "All chess piece textures loaded successfully!" << std::endl;
     }
@@ -32,17 +73,35 @@ bool Game::initialize() {
     return true;
 }
 
+// Redraws on demand: the loop sleeps in waitEvent until input arrives or
+// the engine may have a move, and draws a frame only if the board, the
+// selection or the window changed. Drawn frames are still capped at
+// FRAME_RATE_LIMIT by the window.
 void Game::run() {
     while (window_->isOpen()) {
         handleEvents();
         update();
-        render();
+        // Clicks, engine, book and tablebase moves all show up here
+        if (frameKey_ != board_->getKey() || framePly_ != board_->getHistorySize()) needsRedraw_ = true;
+        if (needsRedraw_ && window_->isOpen()) {
+            render();
+            ++framesRendered_;
+        } else {
+            ++framesSkipped_;
+        }
     }
+    std::cout << "Frames: " << framesRendered_ << " rendered, " << framesSkipped_ << " skipped" << std::endl;
 }
 
 void Game::handleEvents() {
+    // Block until the first event; while a search runs, wake up often
+    // enough to pick up its move promptly
+    sf::Time timeout = sf::milliseconds(pendingSearch_ ? ENGINE_POLL_MS : IDLE_WAIT_MS);
     // SFML3: Event handling with correct enum usage
-    for (auto event = window_->pollEvent(); event.has_value(); event = window_->pollEvent()) {
+    for (auto event = window_->waitEvent(timeout); event.has_value(); event = window_->pollEvent()) {
+        // Anything but pointer motion may change what is on screen
+        if (!event->is<sf::Event::MouseMoved>()) needsRedraw_ = true;
+
         // Handle window closed
         if (event->is<sf::Event::Closed>()) {
             window_->close();
@@ -51,8 +110,10 @@ void Game::handleEvents() {
         // Handle mouse click
         if (auto* mouseEvent = event->getIf<sf::Event::MouseButtonPressed>()) {
             // Use the correct enum value
-            if (mouseEvent->button == sf::Mouse::Button::Left) {
-                board_->handleClick(mouseEvent->position.x, mouseEvent->position.y);
+            // Clicks are ignored while it is the computer's turn
+            if (mouseEvent->button == sf::Mouse::Button::Left &&
+                board_->getCurrentPlayer() != computerColor_) {
+                view_->handleClick(mouseEvent->position.x, mouseEvent->position.y);
             }
         }
         
@@ -66,20 +127,96 @@ void Game::handleEvents() {
     }
 }
 
+// Polls the engine once per frame; the search itself runs on the engine's
+// threads, so the window keeps drawing and handling events meanwhile
 void Game::update() {
-    // Game logic updates can go here
+    if (titlePly_ != board_->getHistorySize()) updateTitle();
+    if (!engine_) return;
+
+    SearchResult result;
+    unsigned id;
+    if (engine_->pollResult(result, id) && id == pendingSearch_) {
+        pendingSearch_ = 0;
+        std::cout << "Computer plays " << result.bestMove.toString()
+                  << " (depth " << result.depth << ", score " << result.score
+                  << ", " << result.nodes << " nodes, " << result.nps() << " nps)" << std::endl;
+        board_->makeMove(result.bestMove);
+        view_->printStatus();
+    }
+
+    if (pendingSearch_ == 0 && board_->getCurrentPlayer() == computerColor_) {
+        startComputerSearch();
+    }
+}
+
+void Game::startComputerSearch() {
+    MoveList moves;
+    board_->getLegalMoves(moves);
+    if (moves.empty() || board_->isThreefoldRepetition() || board_->isHistoryFull()) return;
+
+    // Inside the tables the answer is known: no book and no search
+    Move tablebaseMove;
+    if (tablebases_ && tablebases_->bestMove(*board_, tablebaseMove)) {
+        std::cout << "Computer plays " << tablebaseMove.toString() << " (tablebase)" << std::endl;
+        board_->makeMove(tablebaseMove);
+        view_->printStatus();
+        return;
+    }
+
+    Move bookMove;
+    if (book_ && book_->chooseMove(*board_, static_cast<std::uint32_t>(random_()), bookMove)) {
+        std::cout << "Computer plays " << bookMove.toString() << " (book)" << std::endl;
+        board_->makeMove(bookMove);
+        view_->printStatus();
+        return;
+    }
+
+    SearchLimits limits;
+    limits.timeMs = COMPUTER_MOVE_TIME_MS;
+    engine_->setPosition(*board_);
+    pendingSearch_ = engine_->go(limits);
+}
+
+void Game::updateTitle() {
+    titlePly_ = board_->getHistorySize();
+    std::string status = view_->tablebaseStatus();
+    window_->setTitle(status.empty() ? "Chess Game - SFML3" : "Chess Game - SFML3 - " + status);
 }
 
 void Game::render() {
     window_->clear(sf::Color(50, 50, 50));
     
     // Draw board and pieces
-    board_->draw(*window_);
+    view_->draw(*window_);
     
     window_->display();
+    needsRedraw_ = false;
+    frameKey_ = board_->getKey();
+    framePly_ = board_->getHistorySize();
 }
 
 void Game::cleanup() {
+    // Stops and joins the engine threads
+    if (engine_) {
+        delete engine_;
+        engine_ = nullptr;
+    }
+
+    if (book_) {
+        delete book_;
+        book_ = nullptr;
+    }
+
+    if (tablebases_) {
+        delete tablebases_;
+        tablebases_ = nullptr;
+    }
+    
+    if (view_) {
+        delete view_;
+        view_ = nullptr;
+    }
+    
     if (board_) {
         delete board_;
         board_ = nullptr;
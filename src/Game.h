@@ -1,9 +1,16 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "BoardView.h"
 #include "ChessBoard.h"
+#include "EngineWorker.h"
+#include "PolyglotBook.h"
+#include "Tablebase.h"
 #include <SFML/Graphics.hpp>
+#include <cstdint>
 #include <memory>
+#include <random>
+#include <string>
 
 class Game {
 public:
@@ -12,15 +19,48 @@ public:
 
     bool initialize();
     void run();
+    // Let the engine play the given side; PieceColor::NONE for two humans.
+    // Call before initialize().
+    void setComputerColor(PieceColor color) { computerColor_ = color; }
+    // Polyglot book the computer plays from while it has moves for the
+    // position; its Random64 table must be beside it (see PolyglotBook)
+    void setBook(const std::string& bookPath) { bookPath_ = bookPath; }
+    // Directory of endgame tables: the window title shows "mate in N" and
+    // the computer plays perfectly once they cover the position
+    void setTablebasePath(const std::string& directory) { tablebasePath_ = directory; }
 
 private:
     void handleEvents();
     void update();
+    void startComputerSearch();
+    void updateTitle();
     void render();
     void cleanup();  // This should remain private
 
     sf::RenderWindow* window_;
     ChessBoard* board_;
+    BoardView* view_;
+    EngineWorker* engine_;          // only when the computer plays
+    PolyglotBook* book_;            // only when a book was given and loaded
+    std::string bookPath_;
+    std::mt19937 random_;
+    Tablebases* tablebases_;        // only when tables were found
+    std::string tablebasePath_;
+    int titlePly_;                  // history size the title was made for
+    PieceColor computerColor_;
+    unsigned pendingSearch_;        // id of the search we wait for, 0 if none
+
+    // Frames are drawn only when something changed since the last one
+    bool needsRedraw_;
+    std::uint64_t frameKey_;        // position the last frame showed
+    int framePly_;
+    std::uint64_t framesRendered_;
+    std::uint64_t framesSkipped_;   // wake-ups with nothing new to draw
+
+    static const int COMPUTER_MOVE_TIME_MS = 1000;   // thinking time per computer move
+    static const int FRAME_RATE_LIMIT = 60;
+    static const int IDLE_WAIT_MS = 250;             // longest sleep in waitEvent
+    static const int ENGINE_POLL_MS = 1000 / FRAME_RATE_LIMIT;  // while the engine thinks
 };
 
 #endif
\ No newline at end of file
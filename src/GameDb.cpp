@@ -0,0 +1,154 @@
+#include "GameDb.h"
+#include "Endian.h"
+#include <cstring>
+
+namespace {
+
+const char MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'D', 'B', '1'};
+const std::size_t HEADER_SIZE = 24;
+const std::size_t ENTRY_SIZE = 16;
+
+} // namespace
+
+const char* gameResultText(GameResult result) {
+    switch (result) {
+        case GameResult::WHITE_WINS: return "1-0";
+        case GameResult::BLACK_WINS: return "0-1";
+        case GameResult::DRAW: return "1/2-1/2";
+        default: return "*";
+    }
+}
+
+GameResult gameResultFromText(const std::string& text) {
+    if (text == "1-0") return GameResult::WHITE_WINS;
+    if (text == "0-1") return GameResult::BLACK_WINS;
+    if (text == "1/2-1/2") return GameResult::DRAW;
+    return GameResult::UNKNOWN;
+}
+
+bool GameDbWriter::open(const std::string& path) {
+    entries_.clear();
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) return false;
+
+    // Placeholder header; close() fills in the count and index offset
+    unsigned char header[HEADER_SIZE] = {};
+    file_.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    offset_ = HEADER_SIZE;
+    return static_cast<bool>(file_);
+}
+
+bool GameDbWriter::addGame(const std::string& fen, const std::vector<Move>& moves, GameResult result) {
+    if (fen.size() > 0xFFFF || moves.size() > static_cast<std::size_t>(ChessBoard::MAX_HISTORY)) return false;
+
+    std::vector<unsigned char> data(fen.begin(), fen.end());
+    data.resize(fen.size() + 2 * moves.size());
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        putLe(&data[fen.size() + 2 * i], moves[i].raw(), 2);
+    }
+    file_.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    GameDbEntry entry;
+    entry.offset = offset_;
+    entry.plies = static_cast<int>(moves.size());
+    entry.fenLength = static_cast<int>(fen.size());
+    entry.result = result;
+    entries_.push_back(entry);
+    offset_ += data.size();
+    return static_cast<bool>(file_);
+}
+
+bool GameDbWriter::close() {
+    if (!file_.is_open()) return false;
+
+    for (const GameDbEntry& entry : entries_) {
+        unsigned char record[ENTRY_SIZE] = {};
+        putLe(record, entry.offset, 8);
+        putLe(record + 8, entry.plies, 2);
+        putLe(record + 10, entry.fenLength, 2);
+        record[12] = static_cast<unsigned char>(entry.result);
+        file_.write(reinterpret_cast<const char*>(record), ENTRY_SIZE);
+    }
+
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    putLe(header + 8, entries_.size(), 8);
+    putLe(header + 16, offset_, 8);
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+
+    bool ok = static_cast<bool>(file_);
+    file_.close();
+    return ok;
+}
+
+bool GameDb::open(const std::string& path) {
+    gameCount_ = 0;
+    index_ = nullptr;
+    if (!file_.open(path) || file_.size() < HEADER_SIZE) return false;
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return false;
+    std::uint64_t count = getLe(data + 8, 8);
+    std::uint64_t indexOffset = getLe(data + 16, 8);
+    if (indexOffset < HEADER_SIZE || indexOffset > file_.size() ||
+        (file_.size() - indexOffset) / ENTRY_SIZE != count) {
+        return false;
+    }
+
+    // Every game's data must lie between the header and the index
+    index_ = data + indexOffset;
+    for (std::uint64_t game = 0; game < count; ++game) {
+        GameDbEntry info = entry(game);
+        if (info.offset < HEADER_SIZE || info.offset + info.fenLength + 2 * info.plies > indexOffset) {
+            index_ = nullptr;
+            return false;
+        }
+    }
+    gameCount_ = count;
+    return true;
+}
+
+GameDbEntry GameDb::entry(std::uint64_t game) const {
+    const unsigned char* record = index_ + game * ENTRY_SIZE;
+    GameDbEntry info;
+    info.offset = getLe(record, 8);
+    info.plies = static_cast<int>(getLe(record + 8, 2));
+    info.fenLength = static_cast<int>(getLe(record + 10, 2));
+    info.result = record[12] <= static_cast<unsigned char>(GameResult::DRAW) ? static_cast<GameResult>(record[12])
+                                                                             : GameResult::UNKNOWN;
+    return info;
+}
+
+std::string GameDb::startFen(std::uint64_t game) const {
+    GameDbEntry info = entry(game);
+    return std::string(file_.data() + info.offset, info.fenLength);
+}
+
+Move GameDb::move(std::uint64_t game, int ply) const {
+    GameDbEntry info = entry(game);
+    const unsigned char* codes = reinterpret_cast<const unsigned char*>(file_.data()) + info.offset + info.fenLength;
+    return Move::fromRaw(static_cast<std::uint16_t>(getLe(codes + 2 * ply, 2)));
+}
+
+bool GameDb::replay(std::uint64_t game, ChessBoard& board, bool verify) const {
+    GameDbEntry info = entry(game);
+    if (info.fenLength == 0) {
+        board.initializeBoard();
+    } else if (!board.setFen(startFen(game))) {
+        return false;
+    }
+    if (info.plies > ChessBoard::MAX_HISTORY) return false;
+
+    const unsigned char* codes = reinterpret_cast<const unsigned char*>(file_.data()) + info.offset + info.fenLength;
+    for (int ply = 0; ply < info.plies; ++ply) {
+        Move move = Move::fromRaw(static_cast<std::uint16_t>(getLe(codes + 2 * ply, 2)));
+        if (verify) {
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (!moves.contains(move)) return false;
+        }
+        board.makeMove(move);
+    }
+    return true;
+}
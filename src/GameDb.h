@@ -0,0 +1,72 @@
+#ifndef GAMEDB_H
+#define GAMEDB_H
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary game database. Layout, all integers little-endian:
+//   header   "CHESSDB1", game count (u64), index offset (u64)
+//   games    per game: start FEN text (empty for the start position), then
+//            one 16-bit Move code per ply
+//   index    per game, 16 bytes: data offset (u64), plies (u16),
+//            FEN length (u16), result (u8), 3 bytes padding
+// The index sits at the end so games can be streamed out one by one; any
+// game is then one index lookup away.
+
+enum class GameResult : std::uint8_t { UNKNOWN = 0, WHITE_WINS, BLACK_WINS, DRAW };
+
+// "1-0", "0-1", "1/2-1/2" or "*"
+const char* gameResultText(GameResult result);
+GameResult gameResultFromText(const std::string& text);
+
+struct GameDbEntry {
+    std::uint64_t offset;
+    int plies;
+    int fenLength;
+    GameResult result;
+};
+
+class GameDbWriter {
+public:
+    bool open(const std::string& path);
+    // fen is empty for games from the start position. False if the game is
+    // too long to store or the write failed; writeFailed() tells them apart.
+    bool addGame(const std::string& fen, const std::vector<Move>& moves, GameResult result);
+    bool writeFailed() const { return !file_; }
+    // Writes the index and the header; false on any write error
+    bool close();
+    std::uint64_t gameCount() const { return entries_.size(); }
+
+private:
+    std::ofstream file_;
+    std::vector<GameDbEntry> entries_;
+    std::uint64_t offset_;
+};
+
+class GameDb {
+public:
+    GameDb() : gameCount_(0), index_(nullptr) {}
+
+    // Maps the file and checks the header and index bounds
+    bool open(const std::string& path);
+    std::uint64_t gameCount() const { return gameCount_; }
+    GameDbEntry entry(std::uint64_t game) const;
+
+    std::string startFen(std::uint64_t game) const;
+    Move move(std::uint64_t game, int ply) const;
+    // Sets up the game's start position and plays every move. The codes are
+    // trusted unless verify is set, in which case each one is checked
+    // against the legal moves first. False if the game cannot be replayed.
+    bool replay(std::uint64_t game, ChessBoard& board, bool verify = false) const;
+
+private:
+    MappedFile file_;
+    std::uint64_t gameCount_;
+    const unsigned char* index_;
+};
+
+#endif
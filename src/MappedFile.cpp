@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), released_(0), file_(INVALID_HANDLE_VALUE), mapping_(nullptr) {}
+
+bool MappedFile::open(const std::string& path, Access access) {
+    close();
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        access == RANDOM ? FILE_FLAG_RANDOM_ACCESS : FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size)) {
+        close();
+        return false;
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ == 0) return true;    // an empty file cannot be mapped, but is valid
+
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_) data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (!data_) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+    data_ = nullptr;
+    size_ = 0;
+    released_ = 0;
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+}
+
+void MappedFile::release(std::size_t) {
+    // Windows trims the working set of a read-only view on its own
+}
+
+#else
+
+MappedFile::MappedFile() : data_(nullptr), size_(0), released_(0), fd_(-1) {}
+
+bool MappedFile::open(const std::string& path, Access access) {
+    close();
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) return false;
+
+    struct stat info;
+    if (fstat(fd_, &info) != 0) {
+        close();
+        return false;
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0) return true;    // an empty file cannot be mapped, but is valid
+
+    void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (address == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data_ = static_cast<const char*>(address);
+    madvise(address, size_, access == RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+    data_ = nullptr;
+    size_ = 0;
+    released_ = 0;
+    fd_ = -1;
+}
+
+void MappedFile::release(std::size_t end) {
+    if (!data_) return;
+    std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    std::size_t length = (end < size_ ? end : size_) / page * page;
+    if (length <= released_) return;
+    madvise(const_cast<char*>(data_) + released_, length - released_, MADV_DONTNEED);
+    released_ = length;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
@@ -0,0 +1,45 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on
+// first touch, so opening a multi-GB file costs nothing up front, and
+// release() hands already-processed pages back so resident memory stays
+// bounded while streaming through it.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Read-ahead hint for the OS: streaming front to back, or lookups
+    // scattered over the file
+    enum Access { SEQUENTIAL, RANDOM };
+
+    bool open(const std::string& path, Access access = SEQUENTIAL);
+    void close();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // Drops the pages of [0, end) from memory; they are re-read from disk
+    // if touched again
+    void release(std::size_t end);
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t released_;      // pages below this offset were already dropped
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+};
+
+#endif
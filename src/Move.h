@@ -0,0 +1,121 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include "ChessPiece.h"
+#include <cstdint>
+#include <string>
+
+inline std::string squareName(int square) {
+    std::string name;
+    name += static_cast<char>('a' + (square & 7));
+    name += static_cast<char>('1' + (square >> 3));
+    return name;
+}
+
+// A move packed into 16 bits:
+//   bits 0-5   from square
+//   bits 6-11  to square
+//   bits 12-13 promotion piece (knight, bishop, rook, queen)
+//   bits 14-15 kind (normal, promotion, en passant, castling)
+// Castling is encoded as the king's two-square step. The all-zero value
+// (a1a1) never occurs as a real move and serves as "no move"; Move() gives
+// that value, while a plain "Move m;" is left uninitialized like an int so
+// move lists cost nothing to construct.
+class Move {
+public:
+    enum Kind { NORMAL = 0, PROMOTION = 1, EN_PASSANT = 2, CASTLING = 3 };
+
+    Move() = default;
+    Move(int from, int to) : data_(static_cast<std::uint16_t>(from | (to << 6))) {}
+    Move(int from, int to, PieceType promotion) : data_(0) {
+        if (promotion == PieceType::NONE) {
+            *this = Move(from, to);
+        } else {
+            data_ = static_cast<std::uint16_t>(from | (to << 6) | (promotionCode(promotion) << 12) | (PROMOTION << 14));
+        }
+    }
+
+    static Move enPassant(int from, int to) { return fromRaw(static_cast<std::uint16_t>(from | (to << 6) | (EN_PASSANT << 14))); }
+    static Move castling(int from, int to) { return fromRaw(static_cast<std::uint16_t>(from | (to << 6) | (CASTLING << 14))); }
+    static Move fromRaw(std::uint16_t raw) { Move move; move.data_ = raw; return move; }
+    static Move none() { return fromRaw(0); }
+
+    int from() const { return data_ & 63; }
+    int to() const { return (data_ >> 6) & 63; }
+    Kind kind() const { return static_cast<Kind>(data_ >> 14); }
+    bool isPromotion() const { return kind() == PROMOTION; }
+    bool isEnPassant() const { return kind() == EN_PASSANT; }
+    bool isCastling() const { return kind() == CASTLING; }
+    PieceType promotion() const {
+        static const PieceType types[4] = {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+        return isPromotion() ? types[(data_ >> 12) & 3] : PieceType::NONE;
+    }
+
+    bool isNull() const { return data_ == 0; }
+    std::uint16_t raw() const { return data_; }
+
+    bool operator==(const Move& other) const { return data_ == other.data_; }
+    bool operator!=(const Move& other) const { return data_ != other.data_; }
+
+    // Coordinate notation, e.g. "e2e4" or "e7e8q"
+    std::string toString() const {
+        if (isNull()) return "0000";
+        std::string text = squareName(from()) + squareName(to());
+        switch (promotion()) {
+            case PieceType::QUEEN: text += 'q'; break;
+            case PieceType::ROOK: text += 'r'; break;
+            case PieceType::BISHOP: text += 'b'; break;
+            case PieceType::KNIGHT: text += 'n'; break;
+            default: break;
+        }
+        return text;
+    }
+
+private:
+    static int promotionCode(PieceType type) {
+        switch (type) {
+            case PieceType::BISHOP: return 1;
+            case PieceType::ROOK: return 2;
+            case PieceType::QUEEN: return 3;
+            default: return 0;
+        }
+    }
+
+    std::uint16_t data_;
+};
+
+// Fixed-capacity move list that lives on the stack. 256 is above the largest
+// number of moves any chess position has.
+class MoveList {
+public:
+    static const int CAPACITY = 256;
+
+    MoveList() : size_(0) {}   // moves_ is deliberately left uninitialized
+
+    void add(Move move) { moves_[size_++] = move; }
+    void clear() { size_ = 0; }
+    void truncate(int size) { size_ = size; }
+
+    int size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    Move& operator[](int index) { return moves_[index]; }
+    Move operator[](int index) const { return moves_[index]; }
+
+    Move* begin() { return moves_; }
+    Move* end() { return moves_ + size_; }
+    const Move* begin() const { return moves_; }
+    const Move* end() const { return moves_ + size_; }
+
+    bool contains(Move move) const {
+        for (int i = 0; i < size_; ++i) {
+            if (moves_[i] == move) return true;
+        }
+        return false;
+    }
+
+private:
+    Move moves_[CAPACITY];
+    int size_;
+};
+
+#endif
@@ -0,0 +1,204 @@
+#include "MoveGen.h"
+#include "Attacks.h"
+
+namespace {
+
+const PieceType PROMOTION_TYPES[4] = {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT};
+
+void addPawnMove(int from, int to, bool promotes, MoveList& moves) {
+    if (promotes) {
+        for (PieceType type : PROMOTION_TYPES) {
+            moves.add(Move(from, to, type));
+        }
+    } else {
+        moves.add(Move(from, to));
+    }
+}
+
+bool isAttacked(const Position& position, int square, PieceColor by, const Bitboard* enemyAttacks) {
+    return enemyAttacks ? (*enemyAttacks & squareBit(square)) != 0 : position.isSquareAttacked(square, by);
+}
+
+// Only called when the side to move is not in check
+void generateCastling(const Position& position, PieceColor us, MoveList& moves, const Bitboard* enemyAttacks) {
+    int homeRank = (us == PieceColor::WHITE) ? 0 : 56;
+    int kingSide = (us == PieceColor::WHITE) ? WHITE_KING_SIDE : BLACK_KING_SIDE;
+    int queenSide = (us == PieceColor::WHITE) ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE;
+    int kingFrom = homeRank + 4;
+    PieceColor them = oppositeColor(us);
+    Bitboard rooks = position.pieces(PieceType::ROOK, us);
+
+    if (!position.canCastle(kingSide | queenSide) || position.kingSquare(us) != kingFrom) return;
+
+    // The squares between king and rook must be empty, and the king may not
+    // pass through or land on an attacked square
+    if (position.canCastle(kingSide) && (rooks & squareBit(homeRank + 7)) &&
+        position.isEmpty(homeRank + 5) && position.isEmpty(homeRank + 6) &&
+        !isAttacked(position, homeRank + 5, them, enemyAttacks) &&
+        !isAttacked(position, homeRank + 6, them, enemyAttacks)) {
+        moves.add(Move::castling(kingFrom, homeRank + 6));
+    }
+    if (position.canCastle(queenSide) && (rooks & squareBit(homeRank)) &&
+        position.isEmpty(homeRank + 1) && position.isEmpty(homeRank + 2) && position.isEmpty(homeRank + 3) &&
+        !isAttacked(position, homeRank + 3, them, enemyAttacks) &&
+        !isAttacked(position, homeRank + 2, them, enemyAttacks)) {
+        moves.add(Move::castling(kingFrom, homeRank + 2));
+    }
+}
+
+// Our pieces that are the only blocker between our king and an enemy slider
+Bitboard pinnedPieces(const Position& position, PieceColor us, int king) {
+    PieceColor them = oppositeColor(us);
+    Bitboard occupied = position.occupied();
+    Bitboard queens = position.pieces(PieceType::QUEEN, them);
+    Bitboard snipers = (rookAttacks(king, 0) & (position.pieces(PieceType::ROOK, them) | queens)) |
+                       (bishopAttacks(king, 0) & (position.pieces(PieceType::BISHOP, them) | queens));
+
+    Bitboard pinned = 0;
+    while (snipers) {
+        Bitboard blockers = betweenSquares(king, popLsb(snipers)) & occupied;
+        if (blockers && !(blockers & (blockers - 1))) {
+            pinned |= blockers & position.pieces(us);
+        }
+    }
+    return pinned;
+}
+
+// En passant removes two pawns from one rank at once, which can expose the
+// king along that rank; test it exactly on the resulting occupancy
+bool isLegalEnPassant(const Position& position, int king, int from, int to, int captured) {
+    PieceColor them = oppositeColor(position.sideToMove());
+    Bitboard occupied = (position.occupied() ^ squareBit(from) ^ squareBit(captured)) | squareBit(to);
+    return !(position.attackersTo(king, occupied) & position.pieces(them) & ~squareBit(captured));
+}
+
+// Legal moves straight from check and pin masks: nothing is played and
+// taken back. Checkers and pinned pieces are computed once; a non-king move
+// must land in the check mask (block or capture the single checker) and a
+// pinned piece must stay on the line through its king. With capturesOnly
+// set, quiet moves other than promotions are left out.
+void generate(const Position& position, MoveList& moves, const Bitboard* enemyAttacks, bool capturesOnly) {
+    moves.clear();
+
+    PieceColor us = position.sideToMove();
+    PieceColor them = oppositeColor(us);
+    int side = colorIndex(us);
+    Bitboard own = position.pieces(us);
+    Bitboard enemy = position.pieces(them);
+    Bitboard occupied = position.occupied();
+    int king = position.kingSquare(us);
+    Bitboard destinations = capturesOnly ? enemy : ~own;
+
+    Bitboard checkers = 0;
+    Bitboard pinned = 0;
+    if (king != NO_SQUARE) {
+        if (!enemyAttacks || (*enemyAttacks & squareBit(king))) {
+            checkers = position.attackersTo(king, occupied) & enemy;
+        }
+        pinned = pinnedPieces(position, us, king);
+
+        Bitboard targets = kingAttacks(king) & destinations;
+        if (enemyAttacks && !checkers) {
+            // No slider ray passes through the king, so the map is exact
+            targets &= ~*enemyAttacks;
+            while (targets) {
+                moves.add(Move(king, popLsb(targets)));
+            }
+        } else {
+            // The king may step to any square not attacked once it has left
+            // its own square, so sliders see through where it stood
+            Bitboard withoutKing = occupied ^ squareBit(king);
+            while (targets) {
+                int to = popLsb(targets);
+                if (!(position.attackersTo(to, withoutKing) & enemy)) {
+                    moves.add(Move(king, to));
+                }
+            }
+        }
+
+        // In double check only the king can move
+        if (checkers & (checkers - 1)) return;
+    }
+
+    Bitboard checkMask = checkers ? (betweenSquares(king, lsb(checkers)) | checkers) : ~Bitboard(0);
+
+    // Pawns
+    int forward = (us == PieceColor::WHITE) ? 8 : -8;
+    int startRank = (us == PieceColor::WHITE) ? 1 : 6;
+    int lastRank = (us == PieceColor::WHITE) ? 7 : 0;
+    int enPassant = position.enPassantSquare();
+
+    Bitboard pawns = position.pieces(PieceType::PAWN, us);
+    while (pawns) {
+        int from = popLsb(pawns);
+        Bitboard allowed = checkMask;
+        if (pinned & squareBit(from)) allowed &= lineThrough(king, from);
+
+        int to = from + forward;
+        bool promotes = squareRank(to) == lastRank;
+
+        if (position.isEmpty(to) && (promotes || !capturesOnly)) {
+            if (allowed & squareBit(to)) {
+                addPawnMove(from, to, promotes, moves);
+            }
+            if (!capturesOnly && squareRank(from) == startRank && position.isEmpty(to + forward) &&
+                (allowed & squareBit(to + forward))) {
+                moves.add(Move(from, to + forward));
+            }
+        }
+
+        Bitboard captures = pawnAttacks(side, from) & enemy & allowed;
+        while (captures) {
+            addPawnMove(from, popLsb(captures), promotes, moves);
+        }
+
+        if (enPassant != NO_SQUARE && (pawnAttacks(side, from) & squareBit(enPassant))) {
+            int captured = enPassant - forward;
+            if (king == NO_SQUARE || isLegalEnPassant(position, king, from, enPassant, captured)) {
+                moves.add(Move::enPassant(from, enPassant));
+            }
+        }
+    }
+
+    // Knights, bishops, rooks and queens
+    const PieceType pieceTypes[4] = {PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+    for (PieceType type : pieceTypes) {
+        Bitboard pieces = position.pieces(type, us);
+        while (pieces) {
+            int from = popLsb(pieces);
+            Bitboard targets = pieceAttacks(type, side, from, occupied) & destinations & checkMask;
+            if (pinned & squareBit(from)) targets &= lineThrough(king, from);
+            while (targets) {
+                moves.add(Move(from, popLsb(targets)));
+            }
+        }
+    }
+
+    if (king != NO_SQUARE && !checkers && !capturesOnly) {
+        generateCastling(position, us, moves, enemyAttacks);
+    }
+}
+
+} // namespace
+
+void generateLegalMoves(const Position& position, MoveList& moves) {
+    generate(position, moves, nullptr, false);
+}
+
+void generateLegalMoves(const Position& position, MoveList& moves, Bitboard enemyAttacks) {
+    generate(position, moves, &enemyAttacks, false);
+}
+
+void generateLegalCaptures(const Position& position, MoveList& moves) {
+    generate(position, moves, nullptr, true);
+}
+
+void generateLegalCaptures(const Position& position, MoveList& moves, Bitboard enemyAttacks) {
+    generate(position, moves, &enemyAttacks, true);
+}
+
+bool isInCheck(const Position& position) {
+    PieceColor us = position.sideToMove();
+    int king = position.kingSquare(us);
+    return king != NO_SQUARE && position.isSquareAttacked(king, oppositeColor(us));
+}
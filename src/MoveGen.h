@@ -0,0 +1,21 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "Move.h"
+#include "Position.h"
+
+// Replaces the contents of moves with every legal move for the side to move
+void generateLegalMoves(const Position& position, MoveList& moves);
+// Same, reusing an up-to-date map of every square the opponent attacks so
+// king steps and castling need no attack probes
+void generateLegalMoves(const Position& position, MoveList& moves, Bitboard enemyAttacks);
+
+// Only the legal captures and promotions, for quiescence search. When in
+// check, use generateLegalMoves instead: quiet evasions are not included.
+void generateLegalCaptures(const Position& position, MoveList& moves);
+void generateLegalCaptures(const Position& position, MoveList& moves, Bitboard enemyAttacks);
+
+// True if the side to move is in check
+bool isInCheck(const Position& position);
+
+#endif
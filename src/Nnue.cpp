@@ -0,0 +1,381 @@
+#include "Nnue.h"
+#include "Endian.h"
+#include "Evaluate.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NNUE_HAS_SSE2 1
+#endif
+
+namespace {
+
+const char MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'N', 'N', '1'};
+const std::size_t HEADER_SIZE = 24;
+
+// Features added or removed in one refresh: every non-king piece
+const int MAX_FEATURES = 32;
+
+// Appends values to out as little-endian integers of their own size
+template <typename T>
+void writeValues(std::vector<unsigned char>& out, const T* values, std::size_t count) {
+    std::size_t start = out.size();
+    out.resize(start + count * sizeof(T));
+    for (std::size_t i = 0; i < count; ++i) {
+        putLe(&out[start + i * sizeof(T)], static_cast<std::uint64_t>(values[i]), sizeof(T));
+    }
+}
+
+template <typename T>
+const unsigned char* readValues(const unsigned char* in, T* values, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        values[i] = static_cast<T>(getLe(in + i * sizeof(T), sizeof(T)));
+    }
+    return in + count * sizeof(T);
+}
+
+std::size_t fileSize() {
+    return HEADER_SIZE + NNUE_HIDDEN * 2 + static_cast<std::size_t>(NNUE_INPUTS) * NNUE_HIDDEN * 2 +
+           NNUE_L2 * 4 + NNUE_L2 * 2 * NNUE_HIDDEN + NNUE_L3 * 4 + NNUE_L3 * NNUE_L2 + 4 + NNUE_L3;
+}
+
+// out = in plus the added rows minus the removed rows, in wrapping int16
+void updateRows(const std::int16_t* in, std::int16_t* out, const std::int16_t* const* added, int addedCount,
+                const std::int16_t* const* removed, int removedCount, NnueKernel kernel) {
+#if defined(__AVX2__)
+    if (kernel == NnueKernel::AVX2) {
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            for (int r = 0; r < addedCount; ++r) {
+                sum = _mm256_add_epi16(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(added[r] + i)));
+            }
+            for (int r = 0; r < removedCount; ++r) {
+                sum = _mm256_sub_epi16(sum, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(removed[r] + i)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+        }
+        return;
+    }
+#endif
+#if defined(NNUE_HAS_SSE2)
+    if (kernel != NnueKernel::SCALAR) {
+        for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+            __m128i sum = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            for (int r = 0; r < addedCount; ++r) {
+                sum = _mm_add_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(added[r] + i)));
+            }
+            for (int r = 0; r < removedCount; ++r) {
+                sum = _mm_sub_epi16(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(removed[r] + i)));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sum);
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        std::int16_t sum = in[i];
+        for (int r = 0; r < addedCount; ++r) sum = static_cast<std::int16_t>(sum + added[r][i]);
+        for (int r = 0; r < removedCount; ++r) sum = static_cast<std::int16_t>(sum - removed[r][i]);
+        out[i] = sum;
+    }
+}
+
+// Accumulator values clipped to 0..127
+void clipAccumulator(const std::int16_t* in, std::uint8_t* out, NnueKernel kernel) {
+#if defined(__AVX2__)
+    if (kernel == NnueKernel::AVX2) {
+        const __m256i limit = _mm256_set1_epi8(127);
+        for (int i = 0; i < NNUE_HIDDEN; i += 32) {
+            __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+            __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+            // packus works per 128-bit lane; the permute restores the order
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_min_epu8(packed, limit));
+        }
+        return;
+    }
+#endif
+#if defined(NNUE_HAS_SSE2)
+    if (kernel != NnueKernel::SCALAR) {
+        const __m128i limit = _mm_set1_epi8(127);
+        for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+            __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_min_epu8(_mm_packus_epi16(low, high), limit));
+        }
+        return;
+    }
+#endif
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        out[i] = static_cast<std::uint8_t>(std::min<int>(127, std::max<int>(0, in[i])));
+    }
+}
+
+// out[j] = bias[j] + sum of in[i] * weights[j * inputs + i]; inputs is a
+// multiple of 32 and every input is 0..127, so no kernel saturates
+void dense(const std::uint8_t* in, int inputs, const std::int8_t* weights, const std::int32_t* bias,
+           std::int32_t* out, int outputs, NnueKernel kernel) {
+#if defined(__AVX2__)
+    if (kernel == NnueKernel::AVX2) {
+        const __m256i ones = _mm256_set1_epi16(1);
+        for (int j = 0; j < outputs; ++j) {
+            const std::int8_t* row = weights + static_cast<std::size_t>(j) * inputs;
+            __m256i sum = _mm256_setzero_si256();
+            for (int i = 0; i < inputs; i += 32) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+                __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+            out[j] = bias[j] + _mm_cvtsi128_si32(half);
+        }
+        return;
+    }
+#endif
+#if defined(NNUE_HAS_SSE2)
+    if (kernel != NnueKernel::SCALAR) {
+        // SSE2 has no byte multiply: widen both sides to int16 and use madd
+        const __m128i zero = _mm_setzero_si128();
+        for (int j = 0; j < outputs; ++j) {
+            const std::int8_t* row = weights + static_cast<std::size_t>(j) * inputs;
+            __m128i sum = _mm_setzero_si128();
+            for (int i = 0; i < inputs; i += 16) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+                __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+                __m128i sign = _mm_cmpgt_epi8(zero, w);
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpacklo_epi8(x, zero), _mm_unpacklo_epi8(w, sign)));
+                sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_unpackhi_epi8(x, zero), _mm_unpackhi_epi8(w, sign)));
+            }
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+            sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+            out[j] = bias[j] + _mm_cvtsi128_si32(sum);
+        }
+        return;
+    }
+#endif
+    for (int j = 0; j < outputs; ++j) {
+        const std::int8_t* row = weights + static_cast<std::size_t>(j) * inputs;
+        std::int32_t sum = bias[j];
+        for (int i = 0; i < inputs; ++i) sum += in[i] * row[i];
+        out[j] = sum;
+    }
+}
+
+// Layer output scaled down and clipped to 0..127
+void activate(const std::int32_t* in, std::uint8_t* out, int count) {
+    for (int i = 0; i < count; ++i) {
+        out[i] = static_cast<std::uint8_t>(std::min(127, std::max(0, in[i] >> NnueNetwork::LAYER_SHIFT)));
+    }
+}
+
+} // namespace
+
+const char* nnueKernelName(NnueKernel kernel) {
+    switch (kernel) {
+        case NnueKernel::AVX2: return "avx2";
+        case NnueKernel::SSE2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+bool nnueKernelAvailable(NnueKernel kernel) {
+    switch (kernel) {
+#if defined(__AVX2__)
+        case NnueKernel::AVX2: return true;
+#endif
+#if defined(NNUE_HAS_SSE2)
+        case NnueKernel::SSE2: return true;
+#endif
+        case NnueKernel::SCALAR: return true;
+        default: return false;
+    }
+}
+
+NnueKernel nnueBestKernel() {
+#if defined(__AVX2__)
+    return NnueKernel::AVX2;
+#elif defined(NNUE_HAS_SSE2)
+    return NnueKernel::SSE2;
+#else
+    return NnueKernel::SCALAR;
+#endif
+}
+
+NnueNetwork::NnueNetwork()
+    : featureBias_(NNUE_HIDDEN), featureWeights_(static_cast<std::size_t>(NNUE_INPUTS) * NNUE_HIDDEN),
+      layer1Bias_(NNUE_L2), layer1Weights_(NNUE_L2 * 2 * NNUE_HIDDEN), layer2Bias_(NNUE_L3),
+      layer2Weights_(NNUE_L3 * NNUE_L2), outputBias_(0), outputWeights_(NNUE_L3) {}
+
+// Header: magic, then the input, hidden and layer sizes as u32, so a file
+// for another shape is rejected. The weights follow in declaration order.
+bool NnueNetwork::load(const std::string& path) {
+    std::ifstream input(path, std::ios::binary);
+    if (!input) return false;
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (data.size() != fileSize() || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (getLe(&data[8], 4) != static_cast<std::uint64_t>(NNUE_INPUTS) ||
+        getLe(&data[12], 4) != static_cast<std::uint64_t>(NNUE_HIDDEN) ||
+        getLe(&data[16], 4) != static_cast<std::uint64_t>(NNUE_L2) ||
+        getLe(&data[20], 4) != static_cast<std::uint64_t>(NNUE_L3)) {
+        return false;
+    }
+
+    const unsigned char* in = data.data() + HEADER_SIZE;
+    in = readValues(in, featureBias_.data(), featureBias_.size());
+    in = readValues(in, featureWeights_.data(), featureWeights_.size());
+    in = readValues(in, layer1Bias_.data(), layer1Bias_.size());
+    in = readValues(in, layer1Weights_.data(), layer1Weights_.size());
+    in = readValues(in, layer2Bias_.data(), layer2Bias_.size());
+    in = readValues(in, layer2Weights_.data(), layer2Weights_.size());
+    in = readValues(in, &outputBias_, 1);
+    readValues(in, outputWeights_.data(), outputWeights_.size());
+    return true;
+}
+
+bool NnueNetwork::save(const std::string& path) const {
+    std::vector<unsigned char> data(HEADER_SIZE);
+    std::memcpy(data.data(), MAGIC, sizeof(MAGIC));
+    putLe(&data[8], NNUE_INPUTS, 4);
+    putLe(&data[12], NNUE_HIDDEN, 4);
+    putLe(&data[16], NNUE_L2, 4);
+    putLe(&data[20], NNUE_L3, 4);
+    data.reserve(fileSize());
+    writeValues(data, featureBias_.data(), featureBias_.size());
+    writeValues(data, featureWeights_.data(), featureWeights_.size());
+    writeValues(data, layer1Bias_.data(), layer1Bias_.size());
+    writeValues(data, layer1Weights_.data(), layer1Weights_.size());
+    writeValues(data, layer2Bias_.data(), layer2Bias_.size());
+    writeValues(data, layer2Weights_.data(), layer2Weights_.size());
+    writeValues(data, &outputBias_, 1);
+    writeValues(data, outputWeights_.data(), outputWeights_.size());
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(output);
+}
+
+// Ranges keep typical sums inside the clipping window of each layer
+void NnueNetwork::randomize(std::uint32_t seed) {
+    std::mt19937 random(seed);
+    auto uniform = [&random](int low, int high) { return low + static_cast<int>(random() % (high - low + 1)); };
+
+    for (auto& value : featureBias_) value = static_cast<std::int16_t>(uniform(0, 64));
+    for (auto& value : featureWeights_) value = static_cast<std::int16_t>(uniform(-12, 12));
+    for (auto& value : layer1Bias_) value = uniform(-2048, 2048);
+    for (auto& value : layer1Weights_) value = static_cast<std::int8_t>(uniform(-8, 8));
+    for (auto& value : layer2Bias_) value = uniform(-2048, 2048);
+    for (auto& value : layer2Weights_) value = static_cast<std::int8_t>(uniform(-32, 32));
+    outputBias_ = 0;
+    for (auto& value : outputWeights_) value = static_cast<std::int8_t>(uniform(-64, 64));
+}
+
+// Each side's first 64 neurons count its own material in steps of 127 cp
+// (neuron k holds what lies between 127k and 127(k + 1)), the next 64 the
+// enemy's. Layer 1 splits own minus enemy the same way into 16 positive and
+// 16 negative steps, layer 2 passes them through and the output adds them up.
+void NnueNetwork::setFromEvaluation() {
+    const int STEPS = 64;
+    const int OUTPUT_STEPS = NNUE_L2 / 2;
+    std::fill(featureBias_.begin(), featureBias_.end(), 0);
+    std::fill(featureWeights_.begin(), featureWeights_.end(), 0);
+    std::fill(layer1Bias_.begin(), layer1Bias_.end(), 0);
+    std::fill(layer1Weights_.begin(), layer1Weights_.end(), 0);
+    std::fill(layer2Bias_.begin(), layer2Bias_.end(), 0);
+    std::fill(layer2Weights_.begin(), layer2Weights_.end(), 0);
+    outputBias_ = 0;
+
+    for (int k = 0; k < STEPS; ++k) {
+        featureBias_[k] = featureBias_[STEPS + k] = static_cast<std::int16_t>(-127 * k);
+    }
+    const PieceType types[5] = {PieceType::PAWN, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+    for (int king = 0; king < 64; ++king) {
+        for (PieceType type : types) {
+            for (PieceColor color : {PieceColor::WHITE, PieceColor::BLACK}) {
+                for (int square = 0; square < 64; ++square) {
+                    std::int16_t* row = &featureWeights_[static_cast<std::size_t>(
+                        featureIndex(PieceColor::WHITE, king, type, color, square)) * NNUE_HIDDEN];
+                    int first = color == PieceColor::WHITE ? 0 : STEPS;
+                    std::fill(row + first, row + first + STEPS,
+                              static_cast<std::int16_t>(pieceSquareValue(type, color, square)));
+                }
+            }
+        }
+    }
+
+    const int unit = 1 << LAYER_SHIFT;
+    for (int j = 0; j < NNUE_L2; ++j) {
+        int sign = j < OUTPUT_STEPS ? 1 : -1;
+        std::int8_t* row = &layer1Weights_[j * 2 * NNUE_HIDDEN];
+        std::fill(row, row + STEPS, static_cast<std::int8_t>(sign * unit));
+        std::fill(row + STEPS, row + 2 * STEPS, static_cast<std::int8_t>(-sign * unit));
+        layer1Bias_[j] = -127 * unit * (j % OUTPUT_STEPS);
+    }
+    for (int j = 0; j < NNUE_L3; ++j) {
+        layer2Weights_[j * NNUE_L2 + j] = static_cast<std::int8_t>(unit);
+        outputWeights_[j] = static_cast<std::int8_t>(j < OUTPUT_STEPS ? OUTPUT_SCALE : -OUTPUT_SCALE);
+    }
+}
+
+int NnueNetwork::featureIndex(PieceColor perspective, int kingSquare, PieceType type, PieceColor color, int square) {
+    int flip = perspective == PieceColor::WHITE ? 0 : 56;
+    int kind = 2 * (static_cast<int>(type) - 1) + (color == perspective ? 0 : 1);
+    return ((kingSquare ^ flip) * NNUE_PIECE_KINDS + kind) * 64 + (square ^ flip);
+}
+
+void NnueNetwork::refresh(const Position& position, PieceColor perspective, NnueAccumulator& accumulator,
+                          NnueKernel kernel) const {
+    const std::int16_t* rows[MAX_FEATURES];
+    int count = 0;
+    int king = position.kingSquare(perspective);
+    Bitboard pieces = king == NO_SQUARE ? 0 : position.occupied() & ~position.pieces(PieceType::KING);
+    while (pieces && count < MAX_FEATURES) {
+        int square = popLsb(pieces);
+        int feature = featureIndex(perspective, king, position.pieceTypeAt(square), position.pieceColorAt(square), square);
+        rows[count++] = &featureWeights_[static_cast<std::size_t>(feature) * NNUE_HIDDEN];
+    }
+    updateRows(featureBias_.data(), accumulator.values[colorIndex(perspective)], rows, count, nullptr, 0, kernel);
+}
+
+void NnueNetwork::update(const NnueAccumulator& from, NnueAccumulator& to, PieceColor perspective,
+                         const int* added, int addedCount, const int* removed, int removedCount,
+                         NnueKernel kernel) const {
+    const std::int16_t* addedRows[4];
+    const std::int16_t* removedRows[4];
+    for (int i = 0; i < addedCount; ++i) addedRows[i] = &featureWeights_[static_cast<std::size_t>(added[i]) * NNUE_HIDDEN];
+    for (int i = 0; i < removedCount; ++i) removedRows[i] = &featureWeights_[static_cast<std::size_t>(removed[i]) * NNUE_HIDDEN];
+    int side = colorIndex(perspective);
+    updateRows(from.values[side], to.values[side], addedRows, addedCount, removedRows, removedCount, kernel);
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, PieceColor sideToMove, NnueKernel kernel) const {
+    alignas(32) std::uint8_t input[2 * NNUE_HIDDEN];
+    alignas(32) std::uint8_t hidden1[NNUE_L2];
+    alignas(32) std::uint8_t hidden2[NNUE_L3];
+    std::int32_t sums[NNUE_L2];
+
+    clipAccumulator(accumulator.values[colorIndex(sideToMove)], input, kernel);
+    clipAccumulator(accumulator.values[1 - colorIndex(sideToMove)], input + NNUE_HIDDEN, kernel);
+
+    dense(input, 2 * NNUE_HIDDEN, layer1Weights_.data(), layer1Bias_.data(), sums, NNUE_L2, kernel);
+    activate(sums, hidden1, NNUE_L2);
+    dense(hidden1, NNUE_L2, layer2Weights_.data(), layer2Bias_.data(), sums, NNUE_L3, kernel);
+    activate(sums, hidden2, NNUE_L3);
+    dense(hidden2, NNUE_L3, outputWeights_.data(), &outputBias_, sums, 1, kernel);
+    return sums[0] / OUTPUT_SCALE;
+}
+
+int NnueNetwork::evaluate(const Position& position, NnueKernel kernel) const {
+    NnueAccumulator accumulator;
+    refresh(position, PieceColor::WHITE, accumulator, kernel);
+    refresh(position, PieceColor::BLACK, accumulator, kernel);
+    return evaluate(accumulator, position.sideToMove(), kernel);
+}
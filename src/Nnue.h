@@ -0,0 +1,87 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "Position.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Efficiently updatable neural network evaluation (NNUE), HalfKP layout.
+// Each side sees the board from its own king: one input per (king square,
+// non-king piece, square), with the board flipped for black so both sides
+// share the weights. A move toggles two to four inputs, so the first layer's
+// sums ("accumulators") are updated incrementally by ChessBoard rather than
+// recomputed; only a king move forces a refresh of its own side.
+//
+//   inputs  2 x 40960 sparse   -> 256 int16 per side
+//   layer 1 512 (side to move first) -> 32, int8 weights
+//   layer 2 32 -> 32, int8 weights
+//   output  32 -> 1, centipawns after OUTPUT_SCALE
+//
+// Activations are clipped to 0..127 between layers. All arithmetic is
+// integer, so every kernel gives bit-identical results.
+
+const int NNUE_PIECE_KINDS = 10;                       // pawn..queen, own and enemy
+const int NNUE_INPUTS = 64 * NNUE_PIECE_KINDS * 64;
+const int NNUE_HIDDEN = 256;
+const int NNUE_L2 = 32;
+const int NNUE_L3 = 32;
+
+struct NnueAccumulator {
+    alignas(32) std::int16_t values[2][NNUE_HIDDEN];   // by colorIndex
+};
+
+// Dense-layer implementations; SSE2 and AVX2 exist only in builds for CPUs
+// that have them (see CHESS_ENABLE_AVX2)
+enum class NnueKernel { SCALAR, SSE2, AVX2 };
+
+const char* nnueKernelName(NnueKernel kernel);
+bool nnueKernelAvailable(NnueKernel kernel);
+// The fastest kernel in this build
+NnueKernel nnueBestKernel();
+
+class NnueNetwork {
+public:
+    static const int OUTPUT_SCALE = 16;
+    static const int LAYER_SHIFT = 6;
+
+    NnueNetwork();
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Small random weights; only good for benchmarks and kernel checks
+    void randomize(std::uint32_t seed);
+    // Weights that reproduce evaluate()'s material and piece-square terms
+    // (not the king table, which is not an input), clipped to +-2032 cp
+    void setFromEvaluation();
+
+    // Input of a piece seen from perspective, whose king is on kingSquare
+    static int featureIndex(PieceColor perspective, int kingSquare, PieceType type, PieceColor color, int square);
+
+    // Recomputes one side's accumulator from the position
+    void refresh(const Position& position, PieceColor perspective, NnueAccumulator& accumulator,
+                 NnueKernel kernel = nnueBestKernel()) const;
+    // to = from plus the added and minus the removed inputs, for one side
+    void update(const NnueAccumulator& from, NnueAccumulator& to, PieceColor perspective,
+                const int* added, int addedCount, const int* removed, int removedCount,
+                NnueKernel kernel = nnueBestKernel()) const;
+
+    // Centipawns for the side to move, from accumulators of both sides
+    int evaluate(const NnueAccumulator& accumulator, PieceColor sideToMove,
+                 NnueKernel kernel = nnueBestKernel()) const;
+    // Same, refreshing both sides first
+    int evaluate(const Position& position, NnueKernel kernel = nnueBestKernel()) const;
+
+private:
+    std::vector<std::int16_t> featureBias_;            // NNUE_HIDDEN
+    std::vector<std::int16_t> featureWeights_;         // NNUE_INPUTS rows of NNUE_HIDDEN
+    std::vector<std::int32_t> layer1Bias_;             // NNUE_L2
+    std::vector<std::int8_t> layer1Weights_;           // NNUE_L2 rows of 2 * NNUE_HIDDEN
+    std::vector<std::int32_t> layer2Bias_;             // NNUE_L3
+    std::vector<std::int8_t> layer2Weights_;           // NNUE_L3 rows of NNUE_L2
+    std::int32_t outputBias_;
+    std::vector<std::int8_t> outputWeights_;           // NNUE_L3
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "Notation.h"
+
+namespace {
+
+PieceType pieceFromLetter(char letter) {
+    switch (letter) {
+        case 'N': return PieceType::KNIGHT;
+        case 'B': return PieceType::BISHOP;
+        case 'R': return PieceType::ROOK;
+        case 'Q': return PieceType::QUEEN;
+        case 'K': return PieceType::KING;
+        default: return PieceType::NONE;
+    }
+}
+
+char letterFromPiece(PieceType type) {
+    switch (type) {
+        case PieceType::KNIGHT: return 'N';
+        case PieceType::BISHOP: return 'B';
+        case PieceType::ROOK: return 'R';
+        case PieceType::QUEEN: return 'Q';
+        case PieceType::KING: return 'K';
+        default: return ' ';
+    }
+}
+
+bool isFile(char c) { return c >= 'a' && c <= 'h'; }
+bool isRank(char c) { return c >= '1' && c <= '8'; }
+
+} // namespace
+
+bool parseSan(const ChessBoard& board, const char* text, std::size_t length, Move& move) {
+    // Strip check marks and annotations
+    while (length > 0 && (text[length - 1] == '+' || text[length - 1] == '#' ||
+                          text[length - 1] == '!' || text[length - 1] == '?')) {
+        --length;
+    }
+    if (length < 2) return false;
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    const Position& position = board.getPosition();
+
+    // Castling
+    if (text[0] == 'O' || text[0] == '0') {
+        bool kingSide;
+        std::string castle(text, length);
+        if (castle == "O-O" || castle == "0-0") kingSide = true;
+        else if (castle == "O-O-O" || castle == "0-0-0") kingSide = false;
+        else return false;
+        for (Move candidate : moves) {
+            if (candidate.isCastling() && (candidate.to() > candidate.from()) == kingSide) {
+                move = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    PieceType type = PieceType::PAWN;
+    std::size_t begin = 0;
+    if (pieceFromLetter(text[0]) != PieceType::NONE) {
+        type = pieceFromLetter(text[0]);
+        begin = 1;
+    }
+
+    // Promotion: "e8=Q" or "e8Q"
+    PieceType promotion = PieceType::NONE;
+    if (type == PieceType::PAWN && length >= 3 && pieceFromLetter(text[length - 1]) != PieceType::NONE) {
+        promotion = pieceFromLetter(text[length - 1]);
+        length -= (text[length - 2] == '=') ? 2 : 1;
+    }
+
+    // The destination is the last two characters; anything between the
+    // piece letter and it is disambiguation or the capture mark
+    if (length < begin + 2 || !isFile(text[length - 2]) || !isRank(text[length - 1])) return false;
+    int to = (text[length - 1] - '1') * 8 + (text[length - 2] - 'a');
+    int fromFile = -1, fromRank = -1;
+    for (std::size_t i = begin; i < length - 2; ++i) {
+        if (isFile(text[i])) fromFile = text[i] - 'a';
+        else if (isRank(text[i])) fromRank = text[i] - '1';
+        else if (text[i] != 'x' && text[i] != '-' && text[i] != ':') return false;
+    }
+
+    bool found = false;
+    for (Move candidate : moves) {
+        if (candidate.to() != to || candidate.isCastling()) continue;
+        if (position.pieceTypeAt(candidate.from()) != type) continue;
+        if (fromFile >= 0 && squareCol(candidate.from()) != fromFile) continue;
+        if (fromRank >= 0 && squareRank(candidate.from()) != fromRank) continue;
+        if (candidate.promotion() != promotion) continue;
+        if (found) return false;    // ambiguous
+        move = candidate;
+        found = true;
+    }
+    return found;
+}
+
+std::string moveToSan(ChessBoard& board, Move move) {
+    const Position& position = board.getPosition();
+    std::string san;
+
+    if (move.isCastling()) {
+        san = move.to() > move.from() ? "O-O" : "O-O-O";
+    } else {
+        PieceType type = position.pieceTypeAt(move.from());
+        bool isCapture = move.isEnPassant() || !position.isEmpty(move.to());
+
+        if (type == PieceType::PAWN) {
+            if (isCapture) san += static_cast<char>('a' + squareCol(move.from()));
+        } else {
+            san += letterFromPiece(type);
+
+            // Other pieces of the same type that can reach the same square
+            MoveList moves;
+            board.getLegalMoves(moves);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            for (Move other : moves) {
+                if (other.to() != move.to() || other.from() == move.from() ||
+                    position.pieceTypeAt(other.from()) != type) {
+                    continue;
+                }
+                ambiguous = true;
+                sameFile |= squareCol(other.from()) == squareCol(move.from());
+                sameRank |= squareRank(other.from()) == squareRank(move.from());
+            }
+            if (ambiguous) {
+                std::string from = squareName(move.from());
+                if (!sameFile) san += from[0];
+                else if (!sameRank) san += from[1];
+                else san += from;
+            }
+        }
+
+        if (isCapture) san += 'x';
+        san += squareName(move.to());
+        if (move.isPromotion()) {
+            san += '=';
+            san += letterFromPiece(move.promotion());
+        }
+    }
+
+    board.makeMove(move);
+    PieceColor toMove = board.getCurrentPlayer();
+    if (board.isCheckmate(toMove)) san += '#';
+    else if (board.isCheck(toMove)) san += '+';
+    board.unmakeMove();
+    return san;
+}
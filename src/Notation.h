@@ -0,0 +1,23 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include "ChessBoard.h"
+#include <cstddef>
+#include <string>
+
+// Standard Algebraic Notation ("Nf3", "exd5", "O-O", "e8=Q+"), resolved
+// against the legal moves of the board's current position.
+
+// Finds the legal move the text names. Check and annotation suffixes
+// ("+", "#", "!?") are ignored; "0-0" is accepted for castling. Returns
+// false if the text names no legal move or more than one.
+bool parseSan(const ChessBoard& board, const char* text, std::size_t length, Move& move);
+inline bool parseSan(const ChessBoard& board, const std::string& text, Move& move) {
+    return parseSan(board, text.data(), text.size(), move);
+}
+
+// SAN for a legal move, with the minimal disambiguation and a check or
+// mate suffix. The board is played on and restored.
+std::string moveToSan(ChessBoard& board, Move move);
+
+#endif
@@ -0,0 +1,59 @@
+#include "ParallelSearch.h"
+#include <thread>
+
+ParallelSearch::ParallelSearch(TranspositionTable& table, int threads) : table_(table), stopped_(false) {
+    setThreadCount(threads);
+}
+
+void ParallelSearch::setThreadCount(int threads) {
+    if (threads < 1) threads = 1;
+    searches_.clear();
+    boards_.clear();
+    for (int i = 0; i < threads; ++i) {
+        searches_.emplace_back(new Search(table_));
+        searches_.back()->setThreadIndex(i);
+        searches_.back()->setStopSignal(&stopped_);
+        boards_.emplace_back(new ChessBoard());
+    }
+    searches_[0]->setInfoCallback(onIteration_);
+}
+
+void ParallelSearch::setInfoCallback(std::function<void(const SearchResult&)> callback) {
+    onIteration_ = std::move(callback);
+    searches_[0]->setInfoCallback(onIteration_);
+}
+
+SearchResult ParallelSearch::run(const ChessBoard& board, const SearchLimits& limits) {
+    table_.newSearch();
+    for (auto& copy : boards_) {
+        *copy = board;
+    }
+
+    // Helpers search without limits until thread 0 is done
+    std::vector<std::thread> helpers;
+    std::vector<SearchResult> helperResults(searches_.size());
+    for (std::size_t i = 1; i < searches_.size(); ++i) {
+        helpers.emplace_back([this, i, &helperResults]() {
+            helperResults[i] = searches_[i]->run(*boards_[i], SearchLimits());
+        });
+    }
+
+    SearchResult result = searches_[0]->run(*boards_[0], limits);
+
+    stopped_ = true;
+    for (std::thread& helper : helpers) {
+        helper.join();
+    }
+
+    for (std::size_t i = 1; i < helperResults.size(); ++i) {
+        result.nodes += helperResults[i].nodes;
+        result.tableProbes += helperResults[i].tableProbes;
+        result.tableHits += helperResults[i].tableHits;
+    }
+    result.hashfull = table_.hashfull();
+    return result;
+}
+
+void ParallelSearch::stop() {
+    stopped_ = true;
+}
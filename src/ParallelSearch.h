@@ -0,0 +1,45 @@
+#ifndef PARALLELSEARCH_H
+#define PARALLELSEARCH_H
+
+#include "Search.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Lazy SMP: N independent searches of the same root, one per thread, each
+// on a private copy of the board and all sharing one transposition table.
+// The threads do not coordinate; they speed each other up through the
+// table. Thread 0 runs on the caller's thread and owns the limits and the
+// result; the helpers are stopped and joined as soon as it finishes.
+class ParallelSearch {
+public:
+    explicit ParallelSearch(TranspositionTable& table, int threads = 1);
+
+    void setThreadCount(int threads);
+    int getThreadCount() const { return static_cast<int>(searches_.size()); }
+
+    // Blocks until the search ends. The board is copied, not modified.
+    // Nodes and table statistics in the result are summed over all threads.
+    // run() does not clear an earlier stop(); call clearStop() first.
+    SearchResult run(const ChessBoard& board, const SearchLimits& limits);
+
+    // Ends a running search early; safe to call from another thread. A stop
+    // that lands before run() starts ends that run after its first iteration.
+    void stop();
+    // Arms the next run; call it before handing run() to another thread so
+    // a stop sent in between is not lost
+    void clearStop() { stopped_ = false; }
+
+    // Called from thread 0 after every completed iteration
+    void setInfoCallback(std::function<void(const SearchResult&)> callback);
+
+private:
+    TranspositionTable& table_;
+    std::atomic<bool> stopped_;     // stop signal shared by every thread
+    std::vector<std::unique_ptr<Search>> searches_;
+    std::vector<std::unique_ptr<ChessBoard>> boards_;
+    std::function<void(const SearchResult&)> onIteration_;
+};
+
+#endif
@@ -0,0 +1,165 @@
+#include "Pgn.h"
+#include "Notation.h"
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+// Index just past the end of the line starting at begin
+std::size_t lineEnd(const char* data, std::size_t size, std::size_t begin) {
+    const void* newline = std::memchr(data + begin, '\n', size - begin);
+    return newline ? static_cast<const char*>(newline) - data + 1 : size;
+}
+
+// Leading whitespace aside, the line at begin starts a tag pair
+bool isTagLine(const char* data, std::size_t size, std::size_t begin) {
+    while (begin < size && (data[begin] == ' ' || data[begin] == '\t')) ++begin;
+    return begin < size && data[begin] == '[';
+}
+
+bool isResult(const std::string& token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+} // namespace
+
+bool PgnSplitter::next(PgnGameText& game) {
+    // Skip blank lines and stray text before the first tag
+    std::size_t begin = position_;
+    while (begin < size_ && isSpace(data_[begin])) ++begin;
+    if (begin >= size_) {
+        position_ = size_;
+        return false;
+    }
+
+    bool inMovetext = false;
+    bool inComment = false;     // a {comment} may span lines and contain '['
+    std::size_t line = begin;
+    while (line < size_) {
+        std::size_t end = lineEnd(data_, size_, line);
+        if (!inComment && inMovetext && isTagLine(data_, size_, line)) break;
+
+        for (std::size_t i = line; i < end; ++i) {
+            char c = data_[i];
+            if (inComment) {
+                if (c == '}') inComment = false;
+            } else if (c == '{') {
+                inComment = true;
+                inMovetext = true;
+            } else if (c == ';') {
+                break;      // comment to end of line
+            } else if (c == '[' && !inMovetext) {
+                break;      // tag pair
+            } else if (!isSpace(c)) {
+                inMovetext = true;
+            }
+        }
+        line = end;
+    }
+
+    game.data = data_ + begin;
+    game.size = line - begin;
+    game.offset = begin;
+    position_ = line;
+    return true;
+}
+
+bool pgnTag(const PgnGameText& game, const std::string& name, std::string& value) {
+    std::size_t line = 0;
+    while (line < game.size && isTagLine(game.data, game.size, line)) {
+        std::size_t end = lineEnd(game.data, game.size, line);
+        const char* open = static_cast<const char*>(std::memchr(game.data + line, '[', end - line));
+        const char* text = open + 1;
+        if (static_cast<std::size_t>(game.data + end - text) > name.size() &&
+            std::memcmp(text, name.data(), name.size()) == 0 && isSpace(text[name.size()])) {
+            const char* first = static_cast<const char*>(std::memchr(text, '"', game.data + end - text));
+            const char* last = first ? static_cast<const char*>(
+                                           std::memchr(first + 1, '"', game.data + end - first - 1))
+                                     : nullptr;
+            if (!last) return false;
+            value.assign(first + 1, last);
+            return true;
+        }
+        line = end;
+    }
+    return false;
+}
+
+bool replayPgnGame(const PgnGameText& game, ChessBoard& board, PgnReplay& replay,
+                   const std::function<void(const ChessBoard&, Move)>& onMove) {
+    replay.plies = 0;
+    replay.result.clear();
+    replay.error.clear();
+
+    std::string fen;
+    if (pgnTag(game, "FEN", fen)) {
+        if (!board.setFen(fen)) {
+            replay.error = "invalid FEN tag: " + fen;
+            return false;
+        }
+    } else {
+        board.initializeBoard();
+    }
+
+    const char* text = game.data;
+    std::size_t size = game.size;
+    std::size_t i = 0;
+    int variationDepth = 0;
+    while (i < size) {
+        char c = text[i];
+        if (isSpace(c)) {
+            ++i;
+        } else if (c == '[' && variationDepth == 0 && (i == 0 || text[i - 1] == '\n')) {
+            i = lineEnd(text, size, i);     // tag pair
+        } else if (c == '{') {
+            const void* close = std::memchr(text + i, '}', size - i);
+            i = close ? static_cast<const char*>(close) - text + 1 : size;
+        } else if (c == ';') {
+            i = lineEnd(text, size, i);
+        } else if (c == '(') {
+            ++variationDepth;
+            ++i;
+        } else if (c == ')') {
+            if (variationDepth > 0) --variationDepth;
+            ++i;
+        } else {
+            std::size_t start = i;
+            while (i < size && !isSpace(text[i]) && text[i] != '{' && text[i] != '(' && text[i] != ')' &&
+                   text[i] != ';') {
+                ++i;
+            }
+            if (variationDepth > 0 || text[start] == '$') continue;     // variation move or NAG
+
+            // Move numbers ("12." or "12...") may be glued to the move
+            std::size_t token = start;
+            while (token < i && text[token] >= '0' && text[token] <= '9') ++token;
+            if (token < i && text[token] == '.') {
+                while (token < i && text[token] == '.') ++token;
+            } else {
+                token = start;
+            }
+            if (token == i) continue;
+
+            std::string word(text + token, i - token);
+            if (isResult(word)) {
+                replay.result = word;
+                break;
+            }
+
+            Move move;
+            if (!parseSan(board, text + token, i - token, move)) {
+                replay.error = "illegal or unreadable move " + word + " at ply " + std::to_string(replay.plies + 1);
+                return false;
+            }
+            if (board.isHistoryFull()) {
+                replay.error = "game longer than " + std::to_string(ChessBoard::MAX_HISTORY) + " plies";
+                return false;
+            }
+            if (onMove) onMove(board, move);
+            board.makeMove(move);
+            ++replay.plies;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "ChessBoard.h"
+#include <cstddef>
+#include <functional>
+#include <string>
+
+// One game's text inside a larger buffer (usually a MappedFile); nothing
+// is copied
+struct PgnGameText {
+    const char* data;
+    std::size_t size;
+    std::size_t offset;     // position of the game in the whole buffer
+};
+
+// Splits a PGN buffer into games. A game is its tag pairs plus movetext;
+// the next game starts at the first tag line after movetext.
+class PgnSplitter {
+public:
+    PgnSplitter(const char* data, std::size_t size) : data_(data), size_(size), position_(0) {}
+
+    bool next(PgnGameText& game);
+    std::size_t position() const { return position_; }    // bytes consumed so far
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t position_;
+};
+
+// Value of a tag pair such as [White "Carlsen"]; false if absent
+bool pgnTag(const PgnGameText& game, const std::string& name, std::string& value);
+
+struct PgnReplay {
+    int plies;              // moves played
+    std::string result;     // "1-0", "0-1", "1/2-1/2", "*" or empty
+    std::string error;      // empty if the whole game replayed
+};
+
+// Plays the game's movetext on board, starting from the start position or
+// its [FEN] tag. Comments, variations, NAGs and move numbers are skipped.
+// onMove, if given, sees the board before each move is made. Stops at the
+// first illegal or unreadable move and describes it in replay.error.
+bool replayPgnGame(const PgnGameText& game, ChessBoard& board, PgnReplay& replay,
+                   const std::function<void(const ChessBoard&, Move)>& onMove = nullptr);
+
+#endif
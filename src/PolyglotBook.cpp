@@ -0,0 +1,212 @@
+#include "PolyglotBook.h"
+#include "Attacks.h"
+#include "Endian.h"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const std::size_t ENTRY_SIZE = 16;
+const int CASTLING_OFFSET = 768;
+const int EN_PASSANT_OFFSET = 772;
+const int TURN_OFFSET = 780;
+
+// Published Polyglot test positions: moves from the start position in
+// coordinate notation, and the key of the resulting position
+struct KeyTest {
+    const char* moves;
+    std::uint64_t key;
+};
+
+const KeyTest KEY_TESTS[] = {
+    {"", 0x463b96181691fc9cULL},
+    {"e2e4", 0x823c9b50fd114196ULL},
+    {"e2e4 d7d5", 0x0756b94461c50fb0ULL},
+    {"e2e4 d7d5 e4e5", 0x662fafb965db29d4ULL},
+    {"e2e4 d7d5 e4e5 f7f5", 0x22a48b5a8e47ff78ULL},
+    {"e2e4 d7d5 e4e5 f7f5 e1e2", 0x652a607ca3f242c1ULL},
+    {"e2e4 d7d5 e4e5 f7f5 e1e2 e8f7", 0x00fdd303c946bdd9ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4", 0x3c8123ea7b067637ULL},
+    {"a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a2", 0x5c3f9b829b279560ULL},
+};
+
+// Polyglot orders pieces pawn, knight, bishop, rook, queen, king, black
+// before white
+int pieceKind(PieceType type, PieceColor color) {
+    static const int order[7] = {0, 0, 3, 1, 2, 4, 5};    // by PieceType value
+    return 2 * order[static_cast<int>(type)] + (color == PieceColor::WHITE ? 1 : 0);
+}
+
+bool playCoordinateMove(ChessBoard& board, const std::string& text) {
+    MoveList moves;
+    board.getLegalMoves(moves);
+    for (Move move : moves) {
+        if (move.toString() == text) {
+            board.makeMove(move);
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+const char* const PolyglotBook::KEYS_FILE = "random64.txt";
+
+PolyglotBook::PolyglotBook() : random_(), keysLoaded_(false), count_(0) {}
+
+std::string PolyglotBook::keysPath(const std::string& bookPath) {
+    std::string::size_type slash = bookPath.find_last_of("/\\");
+    return (slash == std::string::npos ? "" : bookPath.substr(0, slash + 1)) + KEYS_FILE;
+}
+
+// Takes the first 781 "0x" followed by 16 hex digits in the file, so C
+// sources and copied tables work alike
+bool PolyglotBook::loadKeys(const std::string& path) {
+    keysLoaded_ = false;
+    std::ifstream input(path);
+    if (!input) return false;
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    std::string text = buffer.str();
+
+    int found = 0;
+    for (std::size_t i = 0; found < 781 && i + 18 <= text.size(); ++i) {
+        if (text[i] != '0' || (text[i + 1] != 'x' && text[i + 1] != 'X')) continue;
+        std::uint64_t value = 0;
+        std::size_t digits = 0;
+        while (digits < 16 && std::isxdigit(static_cast<unsigned char>(text[i + 2 + digits]))) {
+            char c = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i + 2 + digits])));
+            value = (value << 4) | static_cast<std::uint64_t>(c <= '9' ? c - '0' : c - 'a' + 10);
+            ++digits;
+        }
+        if (digits == 16) random_[found++] = value;
+        i += 1 + digits;
+    }
+    keysLoaded_ = found == 781 && checkKeys();
+    return keysLoaded_;
+}
+
+bool PolyglotBook::checkKeys() const {
+    for (const KeyTest& test : KEY_TESTS) {
+        ChessBoard board;
+        std::istringstream moves(test.moves);
+        std::string move;
+        while (moves >> move) {
+            if (!playCoordinateMove(board, move)) return false;
+        }
+        // The table is marked loaded only after this check, so compute the
+        // key regardless of keysLoaded_
+        if (key(board) != test.key) return false;
+    }
+    return true;
+}
+
+bool PolyglotBook::open(const std::string& path) {
+    count_ = 0;
+    if (!loadKeys(keysPath(path))) return false;
+    if (!file_.open(path, MappedFile::RANDOM)) return false;
+    count_ = file_.size() / ENTRY_SIZE;
+    return count_ > 0;
+}
+
+std::uint64_t PolyglotBook::key(const ChessBoard& board) const {
+    const Position& position = board.getPosition();
+    std::uint64_t key = 0;
+
+    for (int color = 0; color < 2; ++color) {
+        PieceColor pieceColor = color == 0 ? PieceColor::WHITE : PieceColor::BLACK;
+        for (int type = 1; type <= 6; ++type) {
+            Bitboard pieces = position.pieces(static_cast<PieceType>(type), pieceColor);
+            int kind = pieceKind(static_cast<PieceType>(type), pieceColor);
+            while (pieces) {
+                key ^= random_[64 * kind + popLsb(pieces)];
+            }
+        }
+    }
+
+    const int rights[4] = {WHITE_KING_SIDE, WHITE_QUEEN_SIDE, BLACK_KING_SIDE, BLACK_QUEEN_SIDE};
+    for (int i = 0; i < 4; ++i) {
+        if (position.canCastle(rights[i])) key ^= random_[CASTLING_OFFSET + i];
+    }
+
+    // The en passant file counts only if a pawn can actually capture
+    PieceColor us = position.sideToMove();
+    int enPassant = position.enPassantSquare();
+    if (enPassant != NO_SQUARE &&
+        (pawnAttacks(colorIndex(oppositeColor(us)), enPassant) & position.pieces(PieceType::PAWN, us))) {
+        key ^= random_[EN_PASSANT_OFFSET + squareCol(enPassant)];
+    }
+
+    if (us == PieceColor::WHITE) key ^= random_[TURN_OFFSET];
+    return key;
+}
+
+std::uint64_t PolyglotBook::entryKey(std::uint64_t index) const {
+    return getBe(reinterpret_cast<const unsigned char*>(file_.data()) + index * ENTRY_SIZE, 8);
+}
+
+int PolyglotBook::probe(const ChessBoard& board, BookMove* moves, int maxMoves) const {
+    if (!isOpen()) return 0;
+
+    std::uint64_t target = key(board);
+    std::uint64_t low = 0, high = count_;
+    while (low < high) {
+        std::uint64_t middle = low + (high - low) / 2;
+        if (entryKey(middle) < target) low = middle + 1; else high = middle;
+    }
+
+    MoveList legal;
+    board.getLegalMoves(legal);
+    const Position& position = board.getPosition();
+    Bitboard king = position.pieces(PieceType::KING, position.sideToMove());
+    const PieceType promotions[5] = {PieceType::NONE, PieceType::KNIGHT, PieceType::BISHOP,
+                                     PieceType::ROOK, PieceType::QUEEN};
+
+    int count = 0;
+    for (std::uint64_t index = low; index < count_ && count < maxMoves && entryKey(index) == target; ++index) {
+        const unsigned char* entry = reinterpret_cast<const unsigned char*>(file_.data()) + index * ENTRY_SIZE;
+        int code = static_cast<int>(getBe(entry + 8, 2));
+        int weight = static_cast<int>(getBe(entry + 10, 2));
+        int to = code & 63;
+        int from = (code >> 6) & 63;
+        int promotion = (code >> 12) & 7;
+        if (promotion > 4) continue;
+
+        // Castling is stored as the king taking its own rook
+        if ((king & squareBit(from)) && (position.pieces(PieceType::ROOK, position.sideToMove()) & squareBit(to))) {
+            to = to > from ? from + 2 : from - 2;
+        }
+
+        // Entries that match no legal move (key collisions, bad books) are dropped
+        for (Move move : legal) {
+            if (move.from() == from && move.to() == to && move.promotion() == promotions[promotion]) {
+                moves[count].move = move;
+                moves[count].weight = weight;
+                ++count;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+bool PolyglotBook::chooseMove(const ChessBoard& board, std::uint32_t random, Move& move) const {
+    BookMove moves[MAX_MOVES];
+    int count = probe(board, moves, MAX_MOVES);
+
+    std::uint32_t total = 0;
+    for (int i = 0; i < count; ++i) total += moves[i].weight;
+    if (total == 0) return false;
+
+    std::uint32_t pick = random % total;
+    for (int i = 0; i < count; ++i) {
+        if (pick < static_cast<std::uint32_t>(moves[i].weight)) {
+            move = moves[i].move;
+            return true;
+        }
+        pick -= moves[i].weight;
+    }
+    return false;
+}
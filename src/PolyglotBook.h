@@ -0,0 +1,61 @@
+#ifndef POLYGLOTBOOK_H
+#define POLYGLOTBOOK_H
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+// Polyglot .bin opening book: 16-byte big-endian entries (key, move,
+// weight, learn) sorted by the Polyglot position key. The file is mapped,
+// and each probe is a binary search that touches a few pages and allocates
+// nothing.
+//
+// Polyglot keys are built from the 781 Random64 numbers published with
+// Polyglot, which are not part of this repository. open() reads them from
+// random64.txt next to the book, any text copy of the table (random.c or
+// the book format page), and accepts them only if they reproduce the
+// published test keys.
+class PolyglotBook {
+public:
+    static const char* const KEYS_FILE;
+
+    PolyglotBook();
+
+    // Maps the book and loads the keys beside it; false if either fails
+    bool open(const std::string& path);
+    bool isOpen() const { return count_ > 0 && keysLoaded_; }
+    bool hasKeys() const { return keysLoaded_; }
+    // Where open() looks for the Random64 table of a book
+    static std::string keysPath(const std::string& bookPath);
+    std::uint64_t size() const { return count_; }
+
+    // Polyglot key of the board's position; needs the keys loaded
+    std::uint64_t key(const ChessBoard& board) const;
+
+    // Fills moves with up to maxMoves book moves for the position, already
+    // matched to legal moves, and returns how many there are
+    int probe(const ChessBoard& board, BookMove* moves, int maxMoves) const;
+    // Picks a book move with probability proportional to its weight;
+    // random is any uniformly distributed number
+    bool chooseMove(const ChessBoard& board, std::uint32_t random, Move& move) const;
+
+    static const int MAX_MOVES = MoveList::CAPACITY;
+
+private:
+    std::uint64_t entryKey(std::uint64_t index) const;
+    bool loadKeys(const std::string& path);
+    bool checkKeys() const;
+
+    std::uint64_t random_[781];
+    bool keysLoaded_;
+    MappedFile file_;
+    std::uint64_t count_;
+};
+
+#endif
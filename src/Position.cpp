@@ -0,0 +1,382 @@
+#include "Position.h"
+#include "Attacks.h"
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+Position::Position() {
+    clear();
+}
+
+void Position::clear() {
+    std::memset(byType_, 0, sizeof(byType_));
+    std::memset(byColor_, 0, sizeof(byColor_));
+    std::memset(board_, 0, sizeof(board_));
+    sideToMove_ = 0;
+    castlingRights_ = NO_CASTLING;
+    enPassantSquare_ = NO_SQUARE;
+    halfmoveClock_ = 0;
+    fullmoveNumber_ = 1;
+    key_ = 0;
+}
+
+void Position::setStartPosition() {
+    clear();
+
+    const PieceType backRank[8] = {
+        PieceType::ROOK, PieceType::KNIGHT, PieceType::BISHOP, PieceType::QUEEN,
+        PieceType::KING, PieceType::BISHOP, PieceType::KNIGHT, PieceType::ROOK
+    };
+
+    for (int col = 0; col < 8; ++col) {
+        putPiece(backRank[col], PieceColor::BLACK, makeSquare(0, col));
+        putPiece(PieceType::PAWN, PieceColor::BLACK, makeSquare(1, col));
+        putPiece(PieceType::PAWN, PieceColor::WHITE, makeSquare(6, col));
+        putPiece(backRank[col], PieceColor::WHITE, makeSquare(7, col));
+    }
+
+    setCastlingRights(ALL_CASTLING);
+}
+
+// Castling rights whose king and rook still stand on their home squares
+static int castlingRightsPossible(const Position& position) {
+    struct Wing { int right; PieceColor color; int king; int rook; };
+    static const Wing WINGS[4] = {
+        {WHITE_KING_SIDE, PieceColor::WHITE, 4, 7},
+        {WHITE_QUEEN_SIDE, PieceColor::WHITE, 4, 0},
+        {BLACK_KING_SIDE, PieceColor::BLACK, 60, 63},
+        {BLACK_QUEEN_SIDE, PieceColor::BLACK, 60, 56}
+    };
+    int rights = NO_CASTLING;
+    for (const Wing& wing : WINGS) {
+        Bitboard king = position.pieces(PieceType::KING, wing.color);
+        Bitboard rooks = position.pieces(PieceType::ROOK, wing.color);
+        if ((king & squareBit(wing.king)) && (rooks & squareBit(wing.rook))) rights |= wing.right;
+    }
+    return rights;
+}
+
+bool Position::setFromFen(const std::string& fen) {
+    clear();
+
+    std::istringstream stream(fen);
+    std::string placement, side, castling, enPassant;
+    int halfmove = 0, fullmove = 1;
+    if (!(stream >> placement >> side)) return false;
+    if (!(stream >> castling)) castling = "-";
+    if (!(stream >> enPassant)) enPassant = "-";
+    stream >> halfmove >> fullmove;
+
+    // Piece placement, rank 8 first
+    int row = 0, col = 0;
+    for (char c : placement) {
+        if (c == '/') {
+            if (col != 8) { clear(); return false; }
+            ++row;
+            col = 0;
+        } else if (c >= '1' && c <= '8') {
+            col += c - '0';
+        } else {
+            PieceType type;
+            switch (c | 0x20) {
+                case 'p': type = PieceType::PAWN; break;
+                case 'n': type = PieceType::KNIGHT; break;
+                case 'b': type = PieceType::BISHOP; break;
+                case 'r': type = PieceType::ROOK; break;
+                case 'q': type = PieceType::QUEEN; break;
+                case 'k': type = PieceType::KING; break;
+                default: clear(); return false;
+            }
+            if (row > 7 || col > 7) { clear(); return false; }
+            putPiece(type, (c & 0x20) ? PieceColor::BLACK : PieceColor::WHITE, makeSquare(row, col));
+            ++col;
+        }
+        if (col > 8) { clear(); return false; }
+    }
+    if (row != 7 || col != 8) { clear(); return false; }
+
+    if (side == "w") setSideToMove(PieceColor::WHITE);
+    else if (side == "b") setSideToMove(PieceColor::BLACK);
+    else { clear(); return false; }
+
+    // Reject what move generation cannot handle: anything but one king a
+    // side, pawns on the back ranks, or the side not to move left in check
+    const Bitboard BACK_RANKS = 0xFFULL | 0xFF00000000000000ULL;
+    if (popCount(pieces(PieceType::KING, PieceColor::WHITE)) != 1 ||
+        popCount(pieces(PieceType::KING, PieceColor::BLACK)) != 1 ||
+        (pieces(PieceType::PAWN) & BACK_RANKS) ||
+        isSquareAttacked(kingSquare(oppositeColor(sideToMove())), sideToMove())) {
+        clear();
+        return false;
+    }
+
+    int rights = NO_CASTLING;
+    for (char c : castling) {
+        switch (c) {
+            case 'K': rights |= WHITE_KING_SIDE; break;
+            case 'Q': rights |= WHITE_QUEEN_SIDE; break;
+            case 'k': rights |= BLACK_KING_SIDE; break;
+            case 'q': rights |= BLACK_QUEEN_SIDE; break;
+            case '-': break;
+            default: clear(); return false;
+        }
+    }
+    if (rights & ~castlingRightsPossible(*this)) { clear(); return false; }
+    setCastlingRights(rights);
+
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' ||
+            (enPassant[1] != '3' && enPassant[1] != '6')) {
+            clear();
+            return false;
+        }
+        // Keep the square only where doMove would have set it: behind a
+        // pawn that just moved two steps, with a pawn of ours to capture
+        int square = (enPassant[1] - '1') * 8 + (enPassant[0] - 'a');
+        PieceColor us = sideToMove();
+        PieceColor them = oppositeColor(us);
+        int pushed = us == PieceColor::WHITE ? square - 8 : square + 8;
+        if (squareRank(square) == (us == PieceColor::WHITE ? 5 : 2) &&
+            (pieces(PieceType::PAWN, them) & squareBit(pushed)) &&
+            (pawnAttacks(colorIndex(them), square) & pieces(PieceType::PAWN, us))) {
+            setEnPassantSquare(square);
+        }
+    }
+
+    halfmoveClock_ = static_cast<std::uint16_t>(halfmove);
+    fullmoveNumber_ = static_cast<std::uint16_t>(fullmove > 0 ? fullmove : 1);
+    return true;
+}
+
+std::string Position::toFen() const {
+    static const char SYMBOLS[2][7] = {{' ', 'P', 'R', 'N', 'B', 'Q', 'K'}, {' ', 'p', 'r', 'n', 'b', 'q', 'k'}};
+
+    std::string fen;
+    fen.reserve(90);
+    for (int row = 0; row < 8; ++row) {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col) {
+            int square = makeSquare(row, col);
+            if (isEmpty(square)) {
+                ++empty;
+                continue;
+            }
+            if (empty) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += SYMBOLS[board_[square] >> 3][board_[square] & 7];
+        }
+        if (empty) fen += static_cast<char>('0' + empty);
+        if (row < 7) fen += '/';
+    }
+
+    fen += sideToMove_ ? " b " : " w ";
+    if (castlingRights_ == NO_CASTLING) fen += '-';
+    if (castlingRights_ & WHITE_KING_SIDE) fen += 'K';
+    if (castlingRights_ & WHITE_QUEEN_SIDE) fen += 'Q';
+    if (castlingRights_ & BLACK_KING_SIDE) fen += 'k';
+    if (castlingRights_ & BLACK_QUEEN_SIDE) fen += 'q';
+    fen += ' ';
+    fen += enPassantSquare_ == NO_SQUARE ? std::string("-") : squareName(enPassantSquare_);
+    fen += ' ' + std::to_string(halfmoveClock_) + ' ' + std::to_string(fullmoveNumber_);
+    return fen;
+}
+
+// Castling rights that survive a move from or to the given square. Moving the
+// king or a rook off its home square, or capturing a rook there, drops them.
+static int castlingRightsKept(int square) {
+    switch (square) {
+        case 0:  return ALL_CASTLING & ~WHITE_QUEEN_SIDE;                      // a1
+        case 4:  return ALL_CASTLING & ~(WHITE_KING_SIDE | WHITE_QUEEN_SIDE);  // e1
+        case 7:  return ALL_CASTLING & ~WHITE_KING_SIDE;                       // h1
+        case 56: return ALL_CASTLING & ~BLACK_QUEEN_SIDE;                      // a8
+        case 60: return ALL_CASTLING & ~(BLACK_KING_SIDE | BLACK_QUEEN_SIDE);  // e8
+        case 63: return ALL_CASTLING & ~BLACK_KING_SIDE;                       // h8
+        default: return ALL_CASTLING;
+    }
+}
+
+void Position::doMove(const Move& move) {
+    UndoState undo;
+    doMove(move, undo);
+}
+
+void Position::doMove(const Move& move, UndoState& undo) {
+    int from = move.from();
+    int to = move.to();
+    PieceType type = pieceTypeAt(from);
+    PieceColor us = sideToMove();
+    bool isCapture = !isEmpty(to);
+
+    undo.move = move;
+    undo.captured = pieceTypeAt(to);
+    undo.castlingRights = castlingRights_;
+    undo.enPassantSquare = enPassantSquare_;
+    undo.halfmoveClock = halfmoveClock_;
+    undo.key = key_;
+
+    if (move.isCastling()) {
+        // Castling: the rook jumps to the square the king crossed
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        int rookTo = (to > from) ? from + 1 : from - 1;
+        movePiece(from, to);
+        movePiece(rookFrom, rookTo);
+    } else {
+        if (move.isEnPassant()) {
+            removePiece(us == PieceColor::WHITE ? to - 8 : to + 8);
+            undo.captured = PieceType::PAWN;
+            isCapture = true;
+        }
+        removePiece(to);
+        movePiece(from, to);
+        if (move.isPromotion()) {
+            removePiece(to);
+            putPiece(move.promotion(), us, to);
+        }
+    }
+
+    int newEnPassant = NO_SQUARE;
+    if (type == PieceType::PAWN && std::abs(to - from) == 16 &&
+        (pawnAttacks(colorIndex(us), (from + to) / 2) & pieces(PieceType::PAWN, oppositeColor(us)))) {
+        newEnPassant = (from + to) / 2;
+    }
+    setEnPassantSquare(newEnPassant);
+    setCastlingRights(castlingRights_ & castlingRightsKept(from) & castlingRightsKept(to));
+    halfmoveClock_ = (type == PieceType::PAWN || isCapture) ? 0 : static_cast<std::uint16_t>(halfmoveClock_ + 1);
+    if (us == PieceColor::BLACK) ++fullmoveNumber_;
+    sideToMove_ ^= 1;
+    key_ ^= Zobrist.side;
+}
+
+void Position::undoMove(const UndoState& undo) {
+    int from = undo.move.from();
+    int to = undo.move.to();
+    sideToMove_ ^= 1;
+    PieceColor us = sideToMove();
+
+    if (undo.move.isPromotion()) {
+        removePiece(to);
+        putPiece(PieceType::PAWN, us, to);
+    }
+
+    if (undo.move.isCastling()) {
+        int rookFrom = (to > from) ? from + 3 : from - 4;
+        int rookTo = (to > from) ? from + 1 : from - 1;
+        movePiece(to, from);
+        movePiece(rookTo, rookFrom);
+    } else {
+        movePiece(to, from);
+        if (undo.captured != PieceType::NONE) {
+            int captureSquare = to;
+            if (undo.move.isEnPassant()) {
+                captureSquare = (us == PieceColor::WHITE) ? to - 8 : to + 8;
+            }
+            putPiece(undo.captured, oppositeColor(us), captureSquare);
+        }
+    }
+
+    castlingRights_ = undo.castlingRights;
+    enPassantSquare_ = undo.enPassantSquare;
+    halfmoveClock_ = undo.halfmoveClock;
+    key_ = undo.key;
+    if (us == PieceColor::BLACK) --fullmoveNumber_;
+}
+
+void Position::setSideToMove(PieceColor color) {
+    if (colorIndex(color) != sideToMove_) key_ ^= Zobrist.side;
+    sideToMove_ = static_cast<std::uint8_t>(colorIndex(color));
+}
+
+void Position::setCastlingRights(int rights) {
+    key_ ^= Zobrist.castling[castlingRights_] ^ Zobrist.castling[rights];
+    castlingRights_ = static_cast<std::uint8_t>(rights);
+}
+
+void Position::setEnPassantSquare(int square) {
+    if (enPassantSquare_ != NO_SQUARE) key_ ^= Zobrist.enPassant[squareCol(enPassantSquare_)];
+    if (square != NO_SQUARE) key_ ^= Zobrist.enPassant[squareCol(square)];
+    enPassantSquare_ = static_cast<std::int8_t>(square);
+}
+
+std::uint64_t Position::computeKey() const {
+    std::uint64_t key = Zobrist.castling[castlingRights_];
+    for (int square = 0; square < 64; ++square) {
+        if (!isEmpty(square)) {
+            key ^= Zobrist.pieces[board_[square] >> 3][(board_[square] & 7) - 1][square];
+        }
+    }
+    if (enPassantSquare_ != NO_SQUARE) key ^= Zobrist.enPassant[squareCol(enPassantSquare_)];
+    if (sideToMove_) key ^= Zobrist.side;
+    return key;
+}
+
+void Position::putPiece(PieceType type, PieceColor color, int square) {
+    Bitboard bit = squareBit(square);
+    byType_[static_cast<int>(type) - 1] |= bit;
+    byColor_[colorIndex(color)] |= bit;
+    board_[square] = static_cast<std::uint8_t>((colorIndex(color) << 3) | static_cast<int>(type));
+    key_ ^= Zobrist.pieces[colorIndex(color)][static_cast<int>(type) - 1][square];
+}
+
+void Position::removePiece(int square) {
+    if (isEmpty(square)) return;
+
+    Bitboard bit = squareBit(square);
+    byType_[static_cast<int>(pieceTypeAt(square)) - 1] &= ~bit;
+    byColor_[board_[square] >> 3] &= ~bit;
+    key_ ^= Zobrist.pieces[board_[square] >> 3][(board_[square] & 7) - 1][square];
+    board_[square] = 0;
+}
+
+void Position::movePiece(int from, int to) {
+    std::uint8_t piece = board_[from];
+    Bitboard fromTo = squareBit(from) | squareBit(to);
+    byType_[(piece & 7) - 1] ^= fromTo;
+    byColor_[piece >> 3] ^= fromTo;
+    key_ ^= Zobrist.pieces[piece >> 3][(piece & 7) - 1][from] ^ Zobrist.pieces[piece >> 3][(piece & 7) - 1][to];
+    board_[to] = piece;
+    board_[from] = 0;
+}
+
+PieceColor Position::pieceColorAt(int square) const {
+    if (isEmpty(square)) return PieceColor::NONE;
+    return (board_[square] >> 3) ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+int Position::kingSquare(PieceColor color) const {
+    Bitboard king = pieces(PieceType::KING, color);
+    return king ? lsb(king) : NO_SQUARE;
+}
+
+Bitboard Position::attackedSquares(PieceColor byColor) const {
+    Bitboard occupiedSquares = occupied();
+    Bitboard pawns = pieces(PieceType::PAWN, byColor);
+    const Bitboard notFileA = ~0x0101010101010101ULL;
+    const Bitboard notFileH = ~0x8080808080808080ULL;
+
+    // Pawn captures for the whole side at once
+    Bitboard attacks = (byColor == PieceColor::WHITE)
+        ? ((pawns & notFileA) << 7) | ((pawns & notFileH) << 9)
+        : ((pawns & notFileA) >> 9) | ((pawns & notFileH) >> 7);
+
+    Bitboard knights = pieces(PieceType::KNIGHT, byColor);
+    while (knights) attacks |= knightAttacks(popLsb(knights));
+
+    Bitboard queens = pieces(PieceType::QUEEN, byColor);
+    Bitboard diagonal = pieces(PieceType::BISHOP, byColor) | queens;
+    while (diagonal) attacks |= bishopAttacks(popLsb(diagonal), occupiedSquares);
+    Bitboard straight = pieces(PieceType::ROOK, byColor) | queens;
+    while (straight) attacks |= rookAttacks(popLsb(straight), occupiedSquares);
+
+    int king = kingSquare(byColor);
+    if (king != NO_SQUARE) attacks |= kingAttacks(king);
+    return attacks;
+}
+
+Bitboard Position::attackersTo(int square, Bitboard occupied) const {
+    return (pawnAttacks(1, square) & pieces(PieceType::PAWN, PieceColor::WHITE)) |
+           (pawnAttacks(0, square) & pieces(PieceType::PAWN, PieceColor::BLACK)) |
+           (knightAttacks(square) & pieces(PieceType::KNIGHT)) |
+           (kingAttacks(square) & pieces(PieceType::KING)) |
+           (rookAttacks(square, occupied) & (pieces(PieceType::ROOK) | pieces(PieceType::QUEEN))) |
+           (bishopAttacks(square, occupied) & (pieces(PieceType::BISHOP) | pieces(PieceType::QUEEN)));
+}
@@ -0,0 +1,120 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include "Bitboard.h"
+#include "ChessPiece.h"
+#include "Move.h"
+#include "Zobrist.h"
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// Castling rights, one bit per side and wing
+enum CastlingRight : int {
+    NO_CASTLING = 0,
+    WHITE_KING_SIDE = 1,
+    WHITE_QUEEN_SIDE = 2,
+    BLACK_KING_SIDE = 4,
+    BLACK_QUEEN_SIDE = 8,
+    ALL_CASTLING = 15
+};
+
+inline int colorIndex(PieceColor color) { return color == PieceColor::BLACK ? 1 : 0; }
+inline PieceColor oppositeColor(PieceColor color) {
+    return color == PieceColor::WHITE ? PieceColor::BLACK : PieceColor::WHITE;
+}
+
+// Everything doMove cannot recompute when a move is taken back
+struct UndoState {
+    Move move;
+    PieceType captured;
+    std::uint8_t castlingRights;
+    std::int8_t enPassantSquare;
+    std::uint16_t halfmoveClock;
+    std::uint64_t key;
+};
+
+// Bitboard position: one board per piece type and per color plus a byte
+// mailbox for O(1) "what stands here" queries. The whole thing is plain data,
+// so copying a Position is a memcpy of a little over two cache lines. The
+// Zobrist key is kept up to date by every edit, including the setters.
+class Position {
+public:
+    Position();
+
+    void clear();
+    void setStartPosition();
+    // Load Forsyth-Edwards Notation; returns false (and leaves the position
+    // cleared) if the string is malformed or the position illegal: not one
+    // king a side, pawns on the back ranks, castling rights without the king
+    // and rook at home, or the side not to move in check
+    bool setFromFen(const std::string& fen);
+    std::string toFen() const;
+
+    // Play a move generated for this position (its kind bits must be set, so
+    // take moves from the generator): handles castling, en passant,
+    // promotion, castling rights, the en passant square and the clocks
+    void doMove(const Move& move);
+    // Same, recording what undoMove needs to restore the position exactly
+    void doMove(const Move& move, UndoState& undo);
+    void undoMove(const UndoState& undo);
+
+    void putPiece(PieceType type, PieceColor color, int square);
+    void removePiece(int square);
+    void movePiece(int from, int to);   // destination must already be empty
+
+    PieceType pieceTypeAt(int square) const { return static_cast<PieceType>(board_[square] & 7); }
+    PieceColor pieceColorAt(int square) const;
+    bool isEmpty(int square) const { return board_[square] == 0; }
+
+    Bitboard pieces(PieceType type) const { return byType_[static_cast<int>(type) - 1]; }
+    Bitboard pieces(PieceColor color) const { return byColor_[colorIndex(color)]; }
+    Bitboard pieces(PieceType type, PieceColor color) const { return pieces(type) & pieces(color); }
+    Bitboard occupied() const { return byColor_[0] | byColor_[1]; }
+    int kingSquare(PieceColor color) const;
+
+    // Pieces of both colors attacking square, with sliders seeing through
+    // everything not in occupied
+    Bitboard attackersTo(int square, Bitboard occupied) const;
+    bool isSquareAttacked(int square, PieceColor byColor) const {
+        return (attackersTo(square, occupied()) & pieces(byColor)) != 0;
+    }
+    // Every square attacked by the given side
+    Bitboard attackedSquares(PieceColor byColor) const;
+
+    PieceColor sideToMove() const { return sideToMove_ ? PieceColor::BLACK : PieceColor::WHITE; }
+    void setSideToMove(PieceColor color);
+
+    int castlingRights() const { return castlingRights_; }
+    bool canCastle(int rights) const { return (castlingRights_ & rights) != 0; }
+    void setCastlingRights(int rights);
+
+    // Only set after a double pawn push when an enemy pawn could capture, so
+    // positions that differ by a useless en passant square hash alike
+    int enPassantSquare() const { return enPassantSquare_; }
+    void setEnPassantSquare(int square);
+
+    int halfmoveClock() const { return halfmoveClock_; }
+    void setHalfmoveClock(int clock) { halfmoveClock_ = static_cast<std::uint16_t>(clock); }
+    int fullmoveNumber() const { return fullmoveNumber_; }
+    void setFullmoveNumber(int number) { fullmoveNumber_ = static_cast<std::uint16_t>(number); }
+
+    std::uint64_t key() const { return key_; }
+    // The key recomputed from scratch; always equals key()
+    std::uint64_t computeKey() const;
+
+private:
+    Bitboard byType_[6];
+    Bitboard byColor_[2];
+    std::uint8_t board_[64];    // 0 = empty, otherwise (colorIndex << 3) | PieceType
+    std::uint8_t sideToMove_;
+    std::uint8_t castlingRights_;
+    std::int8_t enPassantSquare_;
+    std::uint16_t halfmoveClock_;
+    std::uint16_t fullmoveNumber_;
+    std::uint64_t key_;
+};
+
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay trivially copyable");
+
+#endif
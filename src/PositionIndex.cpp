@@ -0,0 +1,190 @@
+#include "PositionIndex.h"
+#include "Endian.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+const char MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'P', 'I', '1'};
+const std::size_t HEADER_SIZE = 16;
+const std::size_t ENTRY_SIZE = 16;
+const std::size_t WRITE_BATCH = 1 << 16;
+
+bool entryLess(const PositionIndexEntry& a, const PositionIndexEntry& b) {
+    if (a.key != b.key) return a.key < b.key;
+    if (a.game != b.game) return a.game < b.game;
+    return a.ply < b.ply;
+}
+
+} // namespace
+
+bool buildPositionIndex(const GameDb& db, const std::string& path, ThreadPool& pool, std::uint64_t& skipped) {
+    skipped = 0;
+    std::uint64_t games = db.gameCount();
+    if (games > 0xFFFFFFFFu) return false;
+
+    // Each game owns a fixed slice of the array, so threads never share a slot
+    std::vector<std::uint64_t> starts(games + 1, 0);
+    for (std::uint64_t game = 0; game < games; ++game) {
+        starts[game + 1] = starts[game] + db.entry(game).plies + 1;
+    }
+    std::vector<PositionIndexEntry> entries(starts[games]);
+
+    // A game that cannot be set up marks its slice with SKIPPED_GAME, which
+    // is dropped before sorting
+    const std::uint32_t SKIPPED_GAME = 0xFFFFFFFFu;
+    std::atomic<std::uint64_t> skippedGames(0);
+    pool.parallelFor(games, 64, [&](std::size_t begin, std::size_t end) {
+        ChessBoard board;
+        for (std::size_t game = begin; game < end; ++game) {
+            GameDbEntry info = db.entry(game);
+            PositionIndexEntry* out = &entries[starts[game]];
+            if (info.fenLength == 0) {
+                board.initializeBoard();
+            } else if (!board.setFen(db.startFen(game))) {
+                for (int ply = 0; ply <= info.plies; ++ply) out[ply].game = SKIPPED_GAME;
+                ++skippedGames;
+                continue;
+            }
+            for (int ply = 0; ply <= info.plies; ++ply) {
+                Move move = ply < info.plies ? db.move(game, ply) : Move::none();
+                out[ply].key = board.getKey();
+                out[ply].game = static_cast<std::uint32_t>(game);
+                out[ply].ply = static_cast<std::uint16_t>(ply);
+                out[ply].move = move;
+                if (ply < info.plies) board.makeMove(move);
+            }
+        }
+    });
+    skipped = skippedGames;
+    if (skipped > 0) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [&](const PositionIndexEntry& entry) { return entry.game == SKIPPED_GAME; }),
+                      entries.end());
+    }
+    std::size_t count = entries.size();
+
+    // Sort one run per worker, then merge neighbouring runs pairwise
+    std::size_t runSize = std::max<std::size_t>(1, (count + pool.size() - 1) / pool.size());
+    std::size_t runs = (count + runSize - 1) / runSize;
+    pool.parallelFor(runs, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t run = begin; run < end; ++run) {
+            auto first = entries.begin() + run * runSize;
+            std::sort(first, first + std::min(runSize, count - run * runSize), entryLess);
+        }
+    });
+    for (std::size_t width = runSize; width < count; width *= 2) {
+        std::size_t pairs = (count + 2 * width - 1) / (2 * width);
+        pool.parallelFor(pairs, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t pair = begin; pair < end; ++pair) {
+                std::size_t first = pair * 2 * width;
+                std::size_t middle = std::min(first + width, count);
+                std::size_t last = std::min(first + 2 * width, count);
+                std::inplace_merge(entries.begin() + first, entries.begin() + middle,
+                                   entries.begin() + last, entryLess);
+            }
+        });
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    putLe(header + 8, count, 8);
+    file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+
+    std::vector<unsigned char> buffer(WRITE_BATCH * ENTRY_SIZE);
+    for (std::size_t begin = 0; begin < count; begin += WRITE_BATCH) {
+        std::size_t end = std::min(begin + WRITE_BATCH, count);
+        unsigned char* out = buffer.data();
+        for (std::size_t i = begin; i < end; ++i, out += ENTRY_SIZE) {
+            putLe(out, entries[i].key, 8);
+            putLe(out + 8, entries[i].game, 4);
+            putLe(out + 12, entries[i].ply, 2);
+            putLe(out + 14, entries[i].move.raw(), 2);
+        }
+        file.write(reinterpret_cast<const char*>(buffer.data()), (end - begin) * ENTRY_SIZE);
+    }
+    return static_cast<bool>(file);
+}
+
+bool PositionIndex::open(const std::string& path) {
+    count_ = 0;
+    entries_ = nullptr;
+    if (!file_.open(path, MappedFile::RANDOM) || file_.size() < HEADER_SIZE) return false;
+
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file_.data());
+    std::uint64_t count = getLe(data + 8, 8);
+    if (std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || (file_.size() - HEADER_SIZE) / ENTRY_SIZE != count) {
+        return false;
+    }
+    count_ = count;
+    entries_ = data + HEADER_SIZE;
+    return true;
+}
+
+std::uint64_t PositionIndex::keyAt(std::uint64_t index) const {
+    return getLe(entries_ + index * ENTRY_SIZE, 8);
+}
+
+PositionIndexEntry PositionIndex::entry(std::uint64_t index) const {
+    const unsigned char* record = entries_ + index * ENTRY_SIZE;
+    PositionIndexEntry result;
+    result.key = getLe(record, 8);
+    result.game = static_cast<std::uint32_t>(getLe(record + 8, 4));
+    result.ply = static_cast<std::uint16_t>(getLe(record + 12, 2));
+    result.move = Move::fromRaw(static_cast<std::uint16_t>(getLe(record + 14, 2)));
+    return result;
+}
+
+// Binary search for both ends; about 2 * log2(n) page touches, so well under
+// a millisecond even for a cold file of tens of millions of entries
+void PositionIndex::find(std::uint64_t key, std::uint64_t& first, std::uint64_t& last) const {
+    std::uint64_t low = 0, high = count_;
+    while (low < high) {
+        std::uint64_t middle = low + (high - low) / 2;
+        if (keyAt(middle) < key) low = middle + 1; else high = middle;
+    }
+    first = low;
+    high = count_;
+    while (low < high) {
+        std::uint64_t middle = low + (high - low) / 2;
+        if (keyAt(middle) <= key) low = middle + 1; else high = middle;
+    }
+    last = low;
+}
+
+void PositionIndex::stats(std::uint64_t key, const GameDb& db, PositionStats& stats, int maxSamples) const {
+    stats.occurrences = 0;
+    stats.games = 0;
+    stats.moves.clear();
+    stats.sampleGames.clear();
+
+    std::uint64_t first, last;
+    find(key, first, last);
+    std::uint32_t previousGame = 0;
+    for (std::uint64_t i = first; i < last; ++i) {
+        PositionIndexEntry hit = entry(i);
+        // Entries of one key are sorted by game, so repeats are adjacent
+        if (i == first || hit.game != previousGame) {
+            ++stats.games;
+            if (static_cast<int>(stats.sampleGames.size()) < maxSamples) stats.sampleGames.push_back(hit.game);
+        }
+        previousGame = hit.game;
+        ++stats.occurrences;
+
+        auto found = std::find_if(stats.moves.begin(), stats.moves.end(),
+                                  [&hit](const MoveStats& moveStats) { return moveStats.move == hit.move; });
+        if (found == stats.moves.end()) {
+            MoveStats moveStats = {hit.move, 0, {0, 0, 0, 0}};
+            stats.moves.push_back(moveStats);
+            found = stats.moves.end() - 1;
+        }
+        ++found->count;
+        if (hit.game < db.gameCount()) ++found->results[static_cast<int>(db.entry(hit.game).result)];
+    }
+
+    std::stable_sort(stats.moves.begin(), stats.moves.end(),
+                     [](const MoveStats& a, const MoveStats& b) { return a.count > b.count; });
+}
@@ -0,0 +1,67 @@
+#ifndef POSITIONINDEX_H
+#define POSITIONINDEX_H
+
+#include "GameDb.h"
+#include "MappedFile.h"
+#include "Move.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Every position of every game in a GameDb, sorted by Zobrist key so all
+// games through a position form one contiguous run. Layout, little-endian:
+//   header   "CHESSPI1", entry count (u64)
+//   entries  16 bytes each: key (u64), game (u32), ply (u16), move (u16)
+// move is the Move code played from the position, or 0 where the game ended.
+
+struct PositionIndexEntry {
+    std::uint64_t key;
+    std::uint32_t game;
+    std::uint16_t ply;
+    Move move;
+};
+
+// Replays all games on the pool, sorts the entries and writes the index.
+// Games whose start FEN does not load are left out and counted in skipped.
+bool buildPositionIndex(const GameDb& db, const std::string& path, ThreadPool& pool, std::uint64_t& skipped);
+
+// How the games through one position continued and ended
+struct MoveStats {
+    Move move;                      // Move::none() for games that ended here
+    std::uint64_t count;
+    std::uint64_t results[4];       // indexed by GameResult
+};
+
+struct PositionStats {
+    std::uint64_t occurrences;      // repetitions within a game count each time
+    std::uint64_t games;
+    std::vector<MoveStats> moves;   // most played first
+    std::vector<std::uint32_t> sampleGames;     // first few game numbers, 0-based
+};
+
+// Read-only view of an index file. Only the pages touched by a lookup are
+// read, so the file is never loaded as a whole.
+class PositionIndex {
+public:
+    PositionIndex() : count_(0), entries_(nullptr) {}
+
+    bool open(const std::string& path);
+    std::uint64_t size() const { return count_; }
+    PositionIndexEntry entry(std::uint64_t index) const;
+
+    // Range [first, last) of the entries with this key
+    void find(std::uint64_t key, std::uint64_t& first, std::uint64_t& last) const;
+    // Collects the continuations of every game through the position; db
+    // supplies the game results
+    void stats(std::uint64_t key, const GameDb& db, PositionStats& stats, int maxSamples = 10) const;
+
+private:
+    std::uint64_t keyAt(std::uint64_t index) const;
+
+    MappedFile file_;
+    std::uint64_t count_;
+    const unsigned char* entries_;
+};
+
+#endif
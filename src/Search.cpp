@@ -0,0 +1,276 @@
+#include "Search.h"
+#include "Evaluate.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+const int TABLE_MOVE_SCORE = 1 << 30;
+const int CAPTURE_SCORE = 1 << 20;
+const int KILLER_SCORE = 1 << 19;
+
+// Time limits are checked once per this many nodes (a power of two)
+const std::uint64_t TIME_CHECK_INTERVAL = 1024;
+
+// Mate scores are stored relative to the node, not the root, so a cached
+// mate stays correct when the position is reached at another ply
+int scoreToTable(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score + ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score - ply;
+    return score;
+}
+
+int scoreFromTable(int score, int ply) {
+    if (score >= MATE_SCORE - MAX_PLY) return score - ply;
+    if (score <= -MATE_SCORE + MAX_PLY) return score + ply;
+    return score;
+}
+
+} // namespace
+
+Search::Search(TranspositionTable& table)
+    : table_(table), threadIndex_(0), stopSignal_(nullptr), stopped_(false), nodes_(0), tableProbes_(0), tableHits_(0),
+      rootDepth_(0), rootBest_() {}
+
+SearchResult Search::run(ChessBoard& board, const SearchLimits& limits) {
+    limits_ = limits;
+    start_ = std::chrono::steady_clock::now();
+    stopped_ = false;
+    nodes_ = 0;
+    tableProbes_ = 0;
+    tableHits_ = 0;
+    rootBest_ = Move();
+    for (int ply = 0; ply < MAX_PLY; ++ply) {
+        killers_[ply][0] = killers_[ply][1] = Move();
+    }
+
+    SearchResult result;
+    int maxDepth = (limits.depth > 0 && limits.depth < MAX_PLY) ? limits.depth : MAX_PLY - 1;
+    int startDepth = (threadIndex_ % 2 == 1) ? 2 : 1;
+    for (rootDepth_ = startDepth; rootDepth_ <= maxDepth; ++rootDepth_) {
+        int score = negamax(board, rootDepth_, 0, -INFINITE_SCORE, INFINITE_SCORE);
+        if (aborted()) break;                      // a partial iteration is discarded
+        if (pvLength_[0] == 0) break;              // no legal moves at the root
+        extendPv(board);
+
+        result.bestMove = rootBest_ = pv_[0][0];
+        result.score = score;
+        result.depth = rootDepth_;
+        result.pvLength = pvLength_[0];
+        std::copy(pv_[0], pv_[0] + pvLength_[0], result.pv);
+        result.nodes = nodes_;
+        result.seconds = elapsedSeconds();
+        result.tableProbes = tableProbes_;
+        result.tableHits = tableHits_;
+        result.hashfull = table_.hashfull();
+        if (onIteration_) onIteration_(result);
+        if (stopped_) break;
+
+        // A mate within the searched depth will not get any shorter
+        if (isMateScore(score) && MATE_SCORE - std::abs(score) <= rootDepth_) break;
+        // The next iteration costs several times this one, so do not start
+        // it with less than half the time left
+        if (limits_.timeMs > 0 && elapsedSeconds() * 1000 * 2 > limits_.timeMs) break;
+    }
+
+    result.nodes = nodes_;
+    result.seconds = elapsedSeconds();
+    result.tableProbes = tableProbes_;
+    result.tableHits = tableHits_;
+    result.hashfull = table_.hashfull();
+    return result;
+}
+
+int Search::negamax(ChessBoard& board, int depth, int ply, int alpha, int beta) {
+    pvLength_[ply] = 0;
+    if (depth <= 0) return quiescence(board, ply, alpha, beta);
+
+    ++nodes_;
+    if (checkLimits()) return 0;
+
+    const Position& position = board.getPosition();
+    if (ply > 0 && (board.isRepetition() || position.halfmoveClock() >= 100)) return 0;
+    if (ply >= MAX_PLY - 1 || board.isHistoryFull()) return board.evaluate();
+
+    // A deep enough cached result settles the node, except at the root,
+    // which must produce a move
+    std::uint64_t key = position.key();
+    TableEntry entry;
+    Move tableMove;
+    ++tableProbes_;
+    if (table_.probe(key, entry)) {
+        ++tableHits_;
+        tableMove = entry.move;
+        int score = scoreFromTable(entry.score, ply);
+        if (ply > 0 && entry.depth >= depth &&
+            (entry.bound == BOUND_EXACT ||
+             (entry.bound == BOUND_LOWER && score >= beta) ||
+             (entry.bound == BOUND_UPPER && score <= alpha))) {
+            return score;
+        }
+    }
+
+    int searchDepth = depth;
+    bool inCheck = board.isCheck(position.sideToMove());
+    if (inCheck) ++depth;       // never stop the main search while in check
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    if (moves.empty()) return inCheck ? -MATE_SCORE + ply : 0;
+
+    int scores[MoveList::CAPACITY];
+    orderMoves(position, moves, ply, tableMove, scores);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove;
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = pickNext(moves, scores, i);
+        bool isQuiet = position.isEmpty(move.to()) && !move.isEnPassant() && !move.isPromotion();
+
+        board.makeMove(move);
+        int score = -negamax(board, depth - 1, ply + 1, -beta, -alpha);
+        board.unmakeMove();
+        if (aborted()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            if (score > alpha) {
+                alpha = score;
+                pv_[ply][0] = move;
+                std::copy(pv_[ply + 1], pv_[ply + 1] + pvLength_[ply + 1], pv_[ply] + 1);
+                pvLength_[ply] = pvLength_[ply + 1] + 1;
+            }
+            if (alpha >= beta) {
+                if (isQuiet && move != killers_[ply][0]) {
+                    killers_[ply][1] = killers_[ply][0];
+                    killers_[ply][0] = move;
+                }
+                break;
+            }
+        }
+    }
+
+    Bound bound = bestScore >= beta ? BOUND_LOWER : (bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+    table_.store(key, searchDepth, bound, scoreToTable(bestScore, ply), bestMove);
+    return bestScore;
+}
+
+// A table cutoff ends the PV at the node that took it, so the line is often
+// a single move. After an iteration the PV is continued with the table moves
+// that follow it, up to the iteration depth, stopping at an illegal move or
+// a repetition.
+void Search::extendPv(ChessBoard& board) {
+    int length = pvLength_[0];
+    for (int i = 0; i < length; ++i) board.makeMove(pv_[0][i]);
+    while (length < rootDepth_ && length < MAX_PLY - 1 && !board.isHistoryFull() && !board.isRepetition()) {
+        TableEntry entry;
+        if (!table_.probe(board.getKey(), entry) || entry.move == Move::none()) break;
+        MoveList moves;
+        board.getLegalMoves(moves);
+        if (!moves.contains(entry.move)) break;
+        pv_[0][length++] = entry.move;
+        board.makeMove(entry.move);
+    }
+    for (int i = 0; i < length; ++i) board.unmakeMove();
+    pvLength_[0] = length;
+}
+
+// Resolves captures so the static evaluation is only taken in quiet
+// positions. The side to move may "stand pat" on the evaluation unless it
+// is in check, in which case every evasion is searched.
+int Search::quiescence(ChessBoard& board, int ply, int alpha, int beta) {
+    pvLength_[ply] = 0;
+    ++nodes_;
+    if (checkLimits()) return 0;
+
+    const Position& position = board.getPosition();
+    if (ply >= MAX_PLY - 1 || board.isHistoryFull()) return board.evaluate();
+
+    bool inCheck = board.isCheck(position.sideToMove());
+    int bestScore = -INFINITE_SCORE;
+    MoveList moves;
+    if (inCheck) {
+        board.getLegalMoves(moves);
+        if (moves.empty()) return -MATE_SCORE + ply;
+    } else {
+        bestScore = board.evaluate();
+        if (bestScore >= beta) return bestScore;
+        if (bestScore > alpha) alpha = bestScore;
+        board.getLegalCaptures(moves);
+    }
+
+    int scores[MoveList::CAPACITY];
+    orderMoves(position, moves, ply, Move(), scores);
+
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = pickNext(moves, scores, i);
+
+        board.makeMove(move);
+        int score = -quiescence(board, ply + 1, -beta, -alpha);
+        board.unmakeMove();
+        if (aborted()) return 0;
+
+        if (score > bestScore) {
+            bestScore = score;
+            if (score > alpha) alpha = score;
+            if (alpha >= beta) break;
+        }
+    }
+    return bestScore;
+}
+
+void Search::orderMoves(const Position& position, MoveList& moves, int ply, Move tableMove, int scores[]) const {
+    for (int i = 0; i < moves.size(); ++i) {
+        Move move = moves[i];
+        PieceType victim = move.isEnPassant() ? PieceType::PAWN : position.pieceTypeAt(move.to());
+
+        int score = 0;
+        if (ply == 0 && move == rootBest_) {
+            score = TABLE_MOVE_SCORE + 1;
+        } else if (move == tableMove) {
+            score = TABLE_MOVE_SCORE;
+        } else if (victim != PieceType::NONE || move.isPromotion()) {
+            // Most valuable victim first, then least valuable attacker
+            score = CAPTURE_SCORE + pieceValue(victim) * 8 + pieceValue(move.promotion()) -
+                    pieceValue(position.pieceTypeAt(move.from())) / 100;
+        } else if (move == killers_[ply][0]) {
+            score = KILLER_SCORE;
+        } else if (move == killers_[ply][1]) {
+            score = KILLER_SCORE - 1;
+        }
+        scores[i] = score;
+    }
+}
+
+// Selection sort step: swap the best remaining move into position index.
+// Cheaper than a full sort because most nodes cut off after a few moves.
+Move Search::pickNext(MoveList& moves, int scores[], int index) {
+    int best = index;
+    for (int i = index + 1; i < moves.size(); ++i) {
+        if (scores[i] > scores[best]) best = i;
+    }
+    std::swap(moves[index], moves[best]);
+    std::swap(scores[index], scores[best]);
+    return moves[index];
+}
+
+// Depth 1 always completes so there is a move to return
+bool Search::checkLimits() {
+    if (rootDepth_ > 1 && !stopped_) {
+        if (stopSignal_ && stopSignal_->load(std::memory_order_relaxed)) {
+            stopped_ = true;
+        } else if (limits_.nodes > 0 && nodes_ >= limits_.nodes) {
+            stopped_ = true;
+        } else if (limits_.timeMs > 0 && (nodes_ & (TIME_CHECK_INTERVAL - 1)) == 0 &&
+                   elapsedSeconds() * 1000 >= limits_.timeMs) {
+            stopped_ = true;
+        }
+    }
+    return aborted();
+}
+
+double Search::elapsedSeconds() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
@@ -0,0 +1,104 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "ChessBoard.h"
+#include "TranspositionTable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+const int MAX_PLY = 64;
+const int MATE_SCORE = 32000;       // mate at the root; mate in n plies scores MATE_SCORE - n
+const int INFINITE_SCORE = 32001;
+
+inline bool isMateScore(int score) {
+    return score >= MATE_SCORE - MAX_PLY || score <= -MATE_SCORE + MAX_PLY;
+}
+
+// Any limit left at 0 is not applied. The search always finishes depth 1,
+// so a legal move comes back however tight the limits are.
+struct SearchLimits {
+    int depth;
+    std::uint64_t nodes;
+    int timeMs;
+
+    SearchLimits() : depth(0), nodes(0), timeMs(0) {}
+};
+
+struct SearchResult {
+    Move bestMove;          // null if the side to move has no legal move
+    int score;              // centipawns from the side to move's view
+    int depth;              // last fully searched depth
+    std::uint64_t nodes;
+    double seconds;
+    Move pv[MAX_PLY];
+    int pvLength;
+    std::uint64_t tableProbes;
+    std::uint64_t tableHits;
+    int hashfull;           // permille of the table filled by this search
+
+    SearchResult()
+        : bestMove(), score(0), depth(0), nodes(0), seconds(0), pvLength(0),
+          tableProbes(0), tableHits(0), hashfull(0) {}
+    std::uint64_t nps() const { return seconds > 0 ? static_cast<std::uint64_t>(nodes / seconds) : 0; }
+    double hitRate() const { return tableProbes > 0 ? static_cast<double>(tableHits) / tableProbes : 0; }
+};
+
+// Negamax alpha-beta with iterative deepening and a quiescence search over
+// captures. Results are cached in a transposition table, which may be
+// shared with other searches; the owner calls newSearch() on the table
+// before each search (ParallelSearch does). Moves are ordered table move
+// first, then captures by most-valuable-victim/least-valuable-attacker,
+// then killers.
+class Search {
+public:
+    explicit Search(TranspositionTable& table);
+
+    // Searches the board's side to move. The board is played on with
+    // makeMove/unmakeMove and is back in its original state on return.
+    SearchResult run(ChessBoard& board, const SearchLimits& limits);
+
+    // Ends a running search as soon as possible; safe to call from another thread
+    void stop() { stopped_ = true; }
+
+    // Lazy SMP helpers with an odd index start one ply deeper, so threads
+    // sharing a table spread over neighbouring depths
+    void setThreadIndex(int index) { threadIndex_ = index; }
+
+    // A flag owned by someone else that stops this search when set; unlike
+    // stop(), it is not cleared when a search starts
+    void setStopSignal(const std::atomic<bool>* signal) { stopSignal_ = signal; }
+
+    // Called after every completed iteration
+    void setInfoCallback(std::function<void(const SearchResult&)> callback) { onIteration_ = std::move(callback); }
+
+private:
+    int negamax(ChessBoard& board, int depth, int ply, int alpha, int beta);
+    int quiescence(ChessBoard& board, int ply, int alpha, int beta);
+    void orderMoves(const Position& position, MoveList& moves, int ply, Move tableMove, int scores[]) const;
+    static Move pickNext(MoveList& moves, int scores[], int index);
+    void extendPv(ChessBoard& board);
+    bool checkLimits();
+    bool aborted() const { return rootDepth_ > 1 && stopped_; }
+    double elapsedSeconds() const;
+
+    TranspositionTable& table_;
+    int threadIndex_;
+    const std::atomic<bool>* stopSignal_;
+    SearchLimits limits_;
+    std::chrono::steady_clock::time_point start_;
+    std::atomic<bool> stopped_;
+    std::uint64_t nodes_;
+    std::uint64_t tableProbes_;
+    std::uint64_t tableHits_;
+    int rootDepth_;
+    Move rootBest_;
+    Move killers_[MAX_PLY][2];
+    Move pv_[MAX_PLY][MAX_PLY];
+    int pvLength_[MAX_PLY];
+    std::function<void(const SearchResult&)> onIteration_;
+};
+
+#endif
@@ -0,0 +1,574 @@
+#include "Tablebase.h"
+#include "Attacks.h"
+#include "Endian.h"
+#include "MoveGen.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <set>
+
+namespace {
+
+const char MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'T', 'B', '1'};
+const std::size_t HEADER_SIZE = 16;
+const int MAX_PIECES = 4;
+const int MAX_PLIES = 250;
+const std::uint8_t INVALID = 255;       // impossible placement, only while generating
+const std::uint8_t NO_EXIT = 255;       // no capture or promotion available
+
+// Value bytes, always from the side to move's point of view
+std::uint8_t winIn(int plies) { return static_cast<std::uint8_t>(plies); }
+std::uint8_t lossIn(int plies) { return static_cast<std::uint8_t>(plies + 2); }
+bool isWin(int value) { return (value & 1) != 0; }
+bool isLoss(int value) { return value != 0 && !(value & 1); }
+int pliesOf(int value) { return isWin(value) ? value : isLoss(value) ? value - 2 : 0; }
+
+// The value for the side that moved into a position with this value
+std::uint8_t negate(int value) {
+    if (value == 0) return 0;
+    return isWin(value) ? lossIn(value + 1) : winIn(value - 1);
+}
+
+// Higher is better for the side to move: quick wins, then draws, then
+// slow losses
+int score(int value) {
+    return isWin(value) ? 1000 - value : isLoss(value) ? -1000 + value : 0;
+}
+
+int pieceStrength(char piece) {
+    switch (piece) {
+        case 'Q': return 9;
+        case 'R': return 5;
+        case 'B': case 'N': return 3;
+        default: return 1;
+    }
+}
+
+PieceType pieceFromLetter(char letter) {
+    switch (letter) {
+        case 'Q': return PieceType::QUEEN;
+        case 'R': return PieceType::ROOK;
+        case 'B': return PieceType::BISHOP;
+        case 'N': return PieceType::KNIGHT;
+        case 'P': return PieceType::PAWN;
+        default: return PieceType::NONE;
+    }
+}
+
+// Pieces besides the king, strongest first
+std::string sortPieces(std::string pieces) {
+    static const std::string order = "QRBNP";
+    std::sort(pieces.begin(), pieces.end(),
+              [](char a, char b) { return order.find(a) < order.find(b); });
+    return pieces;
+}
+
+int sideStrength(const std::string& pieces) {
+    int strength = 0;
+    for (char piece : pieces) strength += pieceStrength(piece);
+    return strength;
+}
+
+// "K<white pieces>K<black pieces>" as placed, before any color flip
+std::string materialOf(const Position& position) {
+    static const char letters[] = "QRBNP";
+    std::string sides[2];
+    for (int color = 0; color < 2; ++color) {
+        PieceColor pieceColor = color == 0 ? PieceColor::WHITE : PieceColor::BLACK;
+        for (const char* letter = letters; *letter; ++letter) {
+            int count = popCount(position.pieces(pieceFromLetter(*letter), pieceColor));
+            sides[color].append(count, *letter);
+        }
+    }
+    return "K" + sides[0] + "K" + sides[1];
+}
+
+// The same position with colors swapped and the board turned round
+Position flipColors(const Position& position) {
+    Position flipped;
+    flipped.clear();
+    Bitboard pieces = position.occupied();
+    while (pieces) {
+        int square = popLsb(pieces);
+        flipped.putPiece(position.pieceTypeAt(square), oppositeColor(position.pieceColorAt(square)), square ^ 56);
+    }
+    flipped.setSideToMove(oppositeColor(position.sideToMove()));
+    if (position.enPassantSquare() != NO_SQUARE) flipped.setEnPassantSquare(position.enPassantSquare() ^ 56);
+    return flipped;
+}
+
+TablebaseResult resultFromValue(int value) {
+    TablebaseResult result;
+    result.outcome = isWin(value) ? TablebaseResult::WIN : isLoss(value) ? TablebaseResult::LOSS : TablebaseResult::DRAW;
+    result.plies = pliesOf(value);
+    return result;
+}
+
+bool leavesTable(const Position& position, Move move) {
+    return !position.isEmpty(move.to()) || move.isEnPassant() || move.isPromotion();
+}
+
+// Calls visit with the index of every position from which the side that
+// just moved could have reached this one without a capture or promotion
+template <typename Visit>
+void forEachPredecessor(const EndgameTable& table, const Position& position, Visit visit) {
+    PieceColor them = oppositeColor(position.sideToMove());
+    int side = colorIndex(them);
+    Bitboard occupied = position.occupied();
+    Bitboard movers = position.pieces(them);
+
+    while (movers) {
+        int square = popLsb(movers);
+        PieceType type = position.pieceTypeAt(square);
+        Bitboard origins = 0;
+        if (type == PieceType::PAWN) {
+            int forward = them == PieceColor::WHITE ? 8 : -8;
+            int from = square - forward;
+            if (squareRank(from) >= 1 && squareRank(from) <= 6 && position.isEmpty(from)) {
+                origins |= squareBit(from);
+                int doubleFrom = from - forward;
+                int startRank = them == PieceColor::WHITE ? 1 : 6;
+                if (doubleFrom >= 0 && doubleFrom < 64 && squareRank(doubleFrom) == startRank &&
+                    position.isEmpty(doubleFrom)) {
+                    origins |= squareBit(doubleFrom);
+                }
+            }
+        } else {
+            origins = pieceAttacks(type, side, square, occupied) & ~occupied;
+        }
+
+        while (origins) {
+            Position previous = position;
+            previous.movePiece(square, popLsb(origins));
+            previous.setSideToMove(them);
+            visit(table.index(previous));
+        }
+    }
+}
+
+} // namespace
+
+EndgameTable::EndgameTable(const std::string& material) : material_(material), size_(2 * 32 * 64), data_(nullptr) {
+    std::size_t blackKing = material.find('K', 1);
+    for (std::size_t i = 1; i < material.size(); ++i) {
+        if (i == blackKing) continue;
+        Slot slot = {pieceFromLetter(material[i]), i < blackKing ? PieceColor::WHITE : PieceColor::BLACK};
+        slots_.push_back(slot);
+        size_ *= 64;
+    }
+}
+
+std::uint64_t EndgameTable::index(const Position& position) const {
+    int whiteKing = position.kingSquare(PieceColor::WHITE);
+    int mirror = squareCol(whiteKing) >= 4 ? 7 : 0;
+    whiteKing ^= mirror;
+
+    std::uint64_t index = position.sideToMove() == PieceColor::WHITE ? 0 : 1;
+    index = index * 32 + squareRank(whiteKing) * 4 + squareCol(whiteKing);
+    index = index * 64 + (position.kingSquare(PieceColor::BLACK) ^ mirror);
+
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        Bitboard pieces = position.pieces(slots_[i].type, slots_[i].color);
+        if (i + 1 < slots_.size() && slots_[i].type == slots_[i + 1].type && slots_[i].color == slots_[i + 1].color) {
+            // Two alike pieces are stored lower square first
+            int a = popLsb(pieces) ^ mirror;
+            int b = lsb(pieces) ^ mirror;
+            index = (index * 64 + std::min(a, b)) * 64 + std::max(a, b);
+            ++i;
+        } else {
+            index = index * 64 + (lsb(pieces) ^ mirror);
+        }
+    }
+    return index;
+}
+
+bool EndgameTable::decode(std::uint64_t index, Position& position) const {
+    int squares[MAX_PIECES - 2];
+    for (int i = static_cast<int>(slots_.size()) - 1; i >= 0; --i) {
+        squares[i] = static_cast<int>(index % 64);
+        index /= 64;
+    }
+    int blackKing = static_cast<int>(index % 64);
+    index /= 64;
+    int whiteKing = static_cast<int>((index % 32) / 4 * 8 + index % 4);
+    PieceColor toMove = index / 32 ? PieceColor::BLACK : PieceColor::WHITE;
+
+    Bitboard used = squareBit(whiteKing);
+    if (used & squareBit(blackKing)) return false;
+    used |= squareBit(blackKing);
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        if (used & squareBit(squares[i])) return false;
+        used |= squareBit(squares[i]);
+        if (slots_[i].type == PieceType::PAWN && (squareRank(squares[i]) == 0 || squareRank(squares[i]) == 7)) {
+            return false;
+        }
+        if (i > 0 && slots_[i].type == slots_[i - 1].type && slots_[i].color == slots_[i - 1].color &&
+            squares[i] < squares[i - 1]) {
+            return false;
+        }
+    }
+
+    position.clear();
+    position.putPiece(PieceType::KING, PieceColor::WHITE, whiteKing);
+    position.putPiece(PieceType::KING, PieceColor::BLACK, blackKing);
+    for (std::size_t i = 0; i < slots_.size(); ++i) {
+        position.putPiece(slots_[i].type, slots_[i].color, squares[i]);
+    }
+    position.setSideToMove(toMove);
+
+    // The side that just moved cannot be in check
+    PieceColor them = oppositeColor(toMove);
+    return !position.isSquareAttacked(position.kingSquare(them), toMove);
+}
+
+void EndgameTable::setValues(std::vector<std::uint8_t>&& values) {
+    file_.close();
+    values_ = std::move(values);
+    data_ = values_.data();
+}
+
+bool EndgameTable::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    putLe(header + 8, size_, 8);
+    file.write(reinterpret_cast<const char*>(header), HEADER_SIZE);
+    file.write(reinterpret_cast<const char*>(data_), static_cast<std::streamsize>(size_));
+    return static_cast<bool>(file);
+}
+
+bool EndgameTable::load(const std::string& path) {
+    values_.clear();
+    data_ = nullptr;
+    if (!file_.open(path, MappedFile::RANDOM) || file_.size() != HEADER_SIZE + size_) return false;
+
+    const unsigned char* header = reinterpret_cast<const unsigned char*>(file_.data());
+    std::uint64_t size = getLe(header + 8, 8);
+    if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || size != size_) {
+        file_.close();
+        return false;
+    }
+    data_ = header + HEADER_SIZE;
+    return true;
+}
+
+std::string Tablebases::canonicalMaterial(const std::string& material) {
+    std::string upper;
+    for (char c : material) upper += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    std::size_t blackKing = upper.find('K', 1);
+    if (upper.empty() || upper[0] != 'K' || blackKing == std::string::npos ||
+        upper.find('K', blackKing + 1) != std::string::npos || upper.size() > MAX_PIECES) {
+        return "";
+    }
+    std::string white = sortPieces(upper.substr(1, blackKing - 1));
+    std::string black = sortPieces(upper.substr(blackKing + 1));
+    for (char piece : white + black) {
+        if (pieceFromLetter(piece) == PieceType::NONE) return "";
+    }
+
+    // The stronger side plays white
+    int whiteStrength = sideStrength(white), blackStrength = sideStrength(black);
+    if (whiteStrength < blackStrength || (whiteStrength == blackStrength && white > black)) std::swap(white, black);
+    return "K" + white + "K" + black;
+}
+
+const EndgameTable* Tablebases::find(const std::string& material) const {
+    auto found = tables_.find(material);
+    return found == tables_.end() ? nullptr : found->second.get();
+}
+
+bool Tablebases::has(const std::string& material) const {
+    return find(material) != nullptr;
+}
+
+int Tablebases::probeValue(const Position& position) const {
+    if (popCount(position.occupied()) > MAX_PIECES) return -1;
+    std::string material = materialOf(position);
+    if (material == "KK") return 0;
+
+    std::string canonical = canonicalMaterial(material);
+    const EndgameTable* table = find(canonical);
+    if (!table) return -1;
+    if (canonical == material) return table->value(table->index(position));
+    return table->value(table->index(flipColors(position)));
+}
+
+bool Tablebases::probe(const ChessBoard& board, TablebaseResult& result) const {
+    const Position& position = board.getPosition();
+    if (position.castlingRights() != NO_CASTLING || popCount(position.occupied()) > MAX_PIECES) return false;
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    if (moves.empty()) {
+        result = resultFromValue(board.isCheck(position.sideToMove()) ? lossIn(0) : 0);
+        return true;
+    }
+
+    if (position.enPassantSquare() == NO_SQUARE) {
+        int value = probeValue(position);
+        if (value < 0) return false;
+        result = resultFromValue(value);
+        return true;
+    }
+
+    // The tables know no en passant rights, so look one move ahead
+    Move best;
+    if (!bestMove(board, best)) return false;
+    Position next = position;
+    next.doMove(best);
+    result = resultFromValue(negate(probeValue(next)));
+    return true;
+}
+
+bool Tablebases::bestMove(const ChessBoard& board, Move& move) const {
+    const Position& position = board.getPosition();
+    if (position.castlingRights() != NO_CASTLING || popCount(position.occupied()) > MAX_PIECES) return false;
+
+    MoveList moves;
+    board.getLegalMoves(moves);
+    int bestScore = -100000;
+    for (Move candidate : moves) {
+        Position next = position;
+        next.doMove(candidate);
+        int value = probeValue(next);
+        if (value < 0) return false;
+        if (score(negate(value)) > bestScore) {
+            bestScore = score(negate(value));
+            move = candidate;
+        }
+    }
+    return !moves.empty();
+}
+
+bool Tablebases::generate(const std::string& material, ThreadPool& pool,
+                          void (*report)(const std::string& material, const TablebaseStats& stats)) {
+    std::string canonical = canonicalMaterial(material);
+    if (canonical.empty()) return false;
+    if (canonical == "KK" || has(canonical)) return true;
+
+    // Every material one capture or promotion away must be ready first
+    std::size_t blackKing = canonical.find('K', 1);
+    std::string sides[2] = {canonical.substr(1, blackKing - 1), canonical.substr(blackKing + 1)};
+    std::set<std::string> smaller;
+    for (int side = 0; side < 2; ++side) {
+        std::string& own = sides[side];
+        std::string& other = sides[1 - side];
+        for (std::size_t i = 0; i < own.size(); ++i) {
+            std::string captured = own.substr(0, i) + own.substr(i + 1);
+            smaller.insert(side == 0 ? "K" + captured + "K" + other : "K" + other + "K" + captured);
+            if (own[i] != 'P') continue;
+            for (char promotion : std::string("QRBN")) {
+                std::string promoted = own;
+                promoted[i] = promotion;
+                smaller.insert(side == 0 ? "K" + promoted + "K" + other : "K" + other + "K" + promoted);
+                for (std::size_t j = 0; j < other.size(); ++j) {
+                    std::string rest = other.substr(0, j) + other.substr(j + 1);
+                    smaller.insert(side == 0 ? "K" + promoted + "K" + rest : "K" + rest + "K" + promoted);
+                }
+            }
+        }
+    }
+    for (const std::string& next : smaller) {
+        if (!generate(next, pool, report)) return false;
+    }
+
+    TablebaseStats stats;
+    if (!generateTable(canonical, pool, stats)) return false;
+    if (report) report(canonical, stats);
+    return true;
+}
+
+// Retrograde analysis. A first pass over every index finds the mates and
+// the best result each position can reach by leaving the table (captures
+// and promotions, looked up in the smaller tables). Then, ply by ply: every
+// position that can move into a position lost in n - 1 plies wins in n, and
+// every predecessor of a new win is checked for being lost, i.e. all of its
+// moves now lead to wins for the opponent. Whatever is left is a draw.
+bool Tablebases::generateTable(const std::string& material, ThreadPool& pool, TablebaseStats& stats) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<EndgameTable> table(new EndgameTable(material));
+    std::uint64_t size = table->size();
+    std::unique_ptr<std::atomic<std::uint8_t>[]> values(new std::atomic<std::uint8_t>[size]());
+    std::vector<std::uint8_t> exits(size, NO_EXIT);
+    std::vector<std::vector<std::uint64_t>> losses(MAX_PLIES + 3);
+    std::mutex mutex;
+    int longestExitWin = 0;
+
+    pool.parallelFor(size, 4096, [&](std::size_t begin, std::size_t end) {
+        std::vector<std::pair<int, std::uint64_t>> found;
+        int longest = 0;
+        Position position;
+        MoveList moves;
+        for (std::size_t i = begin; i < end; ++i) {
+            if (!table->decode(i, position)) {
+                values[i].store(INVALID, std::memory_order_relaxed);
+                continue;
+            }
+            generateLegalMoves(position, moves);
+            if (moves.empty()) {
+                if (isInCheck(position)) {
+                    values[i].store(lossIn(0), std::memory_order_relaxed);
+                    found.emplace_back(0, i);
+                }
+                continue;
+            }
+
+            int best = -1;
+            int inside = 0;
+            for (Move move : moves) {
+                if (!leavesTable(position, move)) {
+                    ++inside;
+                    continue;
+                }
+                Position next = position;
+                next.doMove(move);
+                int smaller = probeValue(next);
+                if (smaller < 0) continue;      // cannot happen: generate() built it first
+                int value = negate(smaller);
+                if (best < 0 || score(value) > score(best)) best = value;
+            }
+            if (best < 0) continue;
+
+            exits[i] = static_cast<std::uint8_t>(best);
+            if (isWin(best)) longest = std::max(longest, best);
+            if (inside == 0 && isLoss(best)) {
+                values[i].store(static_cast<std::uint8_t>(best), std::memory_order_relaxed);
+                found.emplace_back(pliesOf(best), i);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& loss : found) losses[loss.first].push_back(loss.second);
+        longestExitWin = std::max(longestExitWin, longest);
+    });
+
+    // Plies of the loss if every move of the position at index now loses,
+    // otherwise -1
+    auto lossPlies = [&](std::uint64_t index, Position& position, MoveList& moves) {
+        int exit = exits[index];
+        if (exit != NO_EXIT && !isLoss(exit)) return -1;
+        if (!table->decode(index, position)) return -1;
+        generateLegalMoves(position, moves);
+        int plies = exit == NO_EXIT ? 0 : pliesOf(exit);
+        for (Move move : moves) {
+            if (leavesTable(position, move)) continue;
+            Position next = position;
+            next.doMove(move);
+            int value = values[table->index(next)].load(std::memory_order_relaxed);
+            if (!isWin(value)) return -1;
+            plies = std::max(plies, value + 1);
+        }
+        return plies;
+    };
+
+    for (int plies = 1; plies <= MAX_PLIES; plies += 2) {
+        std::vector<std::uint64_t> wins;
+
+        const std::vector<std::uint64_t>& lost = losses[plies - 1];
+        pool.parallelFor(lost.size(), 256, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::uint64_t> found;
+            Position position;
+            for (std::size_t i = begin; i < end; ++i) {
+                table->decode(lost[i], position);
+                forEachPredecessor(*table, position, [&](std::uint64_t previous) {
+                    std::uint8_t unknown = 0;
+                    if (values[previous].compare_exchange_strong(unknown, winIn(plies))) found.push_back(previous);
+                });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            wins.insert(wins.end(), found.begin(), found.end());
+        });
+
+        if (plies <= longestExitWin) {
+            pool.parallelFor(size, 1 << 16, [&](std::size_t begin, std::size_t end) {
+                std::vector<std::uint64_t> found;
+                for (std::size_t i = begin; i < end; ++i) {
+                    std::uint8_t unknown = 0;
+                    if (exits[i] == winIn(plies) && values[i].compare_exchange_strong(unknown, winIn(plies))) {
+                        found.push_back(i);
+                    }
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                wins.insert(wins.end(), found.begin(), found.end());
+            });
+        }
+
+        pool.parallelFor(wins.size(), 256, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::pair<int, std::uint64_t>> found;
+            Position position, candidate;
+            MoveList moves;
+            for (std::size_t i = begin; i < end; ++i) {
+                table->decode(wins[i], position);
+                forEachPredecessor(*table, position, [&](std::uint64_t previous) {
+                    if (values[previous].load(std::memory_order_relaxed) != 0) return;
+                    int loss = lossPlies(previous, candidate, moves);
+                    if (loss < 0 || loss > MAX_PLIES) return;
+                    std::uint8_t unknown = 0;
+                    if (values[previous].compare_exchange_strong(unknown, lossIn(loss))) {
+                        found.emplace_back(loss, previous);
+                    }
+                });
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& loss : found) losses[loss.first].push_back(loss.second);
+        });
+
+        bool pending = plies < longestExitWin;
+        for (int later = plies + 1; later <= MAX_PLIES && !pending; ++later) pending = !losses[later].empty();
+        if (wins.empty() && !pending) break;
+        std::vector<std::uint64_t>().swap(losses[plies - 1]);
+    }
+
+    std::vector<std::uint8_t> result(size);
+    stats.wins = stats.draws = stats.losses = 0;
+    stats.longestPlies = 0;
+    for (std::uint64_t i = 0; i < size; ++i) {
+        std::uint8_t value = values[i].load(std::memory_order_relaxed);
+        if (value == INVALID) {
+            result[i] = 0;
+            continue;
+        }
+        result[i] = value;
+        if (isWin(value)) {
+            ++stats.wins;
+            if (i < size / 2) stats.longestPlies = std::max(stats.longestPlies, static_cast<int>(value));
+        } else if (isLoss(value)) {
+            ++stats.losses;
+        } else {
+            ++stats.draws;
+        }
+    }
+    table->setValues(std::move(result));
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    tables_[material] = std::move(table);
+    return true;
+}
+
+bool Tablebases::save(const std::string& directory) const {
+    for (const auto& entry : tables_) {
+        if (entry.second->isMapped()) continue;
+        if (!entry.second->save(directory + "/" + entry.first + ".tb")) return false;
+    }
+    return true;
+}
+
+int Tablebases::load(const std::string& directory) {
+    std::error_code error;
+    int loaded = 0;
+    for (const auto& file : std::filesystem::directory_iterator(directory, error)) {
+        if (file.path().extension() != ".tb") continue;
+        std::string material = file.path().stem().string();
+        if (canonicalMaterial(material) != material || has(material)) continue;
+
+        std::unique_ptr<EndgameTable> table(new EndgameTable(material));
+        if (table->load(file.path().string())) {
+            tables_[material] = std::move(table);
+            ++loaded;
+        }
+    }
+    return loaded;
+}
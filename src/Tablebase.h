@@ -0,0 +1,112 @@
+#ifndef TABLEBASE_H
+#define TABLEBASE_H
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Perfect-play tables for endings with at most four pieces, kings
+// included. Materials are named by the white then the black pieces, each
+// starting with its king: "KQK", "KBNK", "KQKR". A table covers one
+// material with white as the stronger side; positions with the colors the
+// other way round are probed through their color-flipped mirror.
+//
+// Each position is one byte: 0 for a draw, an odd n for "the side to move
+// mates in n plies", an even n >= 2 for "the side to move is mated in n - 2
+// plies". Tables index the white king on files a-d only (the rest is the
+// mirror image) and assume no castling rights and no en passant capture;
+// the fifty-move rule is ignored.
+
+struct TablebaseResult {
+    enum Outcome { LOSS = -1, DRAW = 0, WIN = 1 };
+
+    Outcome outcome;        // for the side to move
+    int plies;              // until mate; 0 when mated and for draws
+
+    int mateInMoves() const { return (plies + 1) / 2; }
+};
+
+class EndgameTable {
+public:
+    // material must already be in canonical form (see Tablebases)
+    explicit EndgameTable(const std::string& material);
+
+    const std::string& material() const { return material_; }
+    std::uint64_t size() const { return size_; }
+
+    // Index of a position of this material, white to the left when mirrored
+    std::uint64_t index(const Position& position) const;
+    // The position at index; false for impossible placements
+    bool decode(std::uint64_t index, Position& position) const;
+    std::uint8_t value(std::uint64_t index) const { return data_[index]; }
+
+    void setValues(std::vector<std::uint8_t>&& values);
+    // True for a table mapped from a file rather than generated
+    bool isMapped() const { return values_.empty(); }
+    bool save(const std::string& path) const;
+    // Maps the file; pages are read only when probed
+    bool load(const std::string& path);
+
+private:
+    struct Slot {
+        PieceType type;
+        PieceColor color;
+    };
+
+    std::string material_;
+    std::vector<Slot> slots_;       // pieces besides the kings
+    std::uint64_t size_;
+    std::vector<std::uint8_t> values_;
+    MappedFile file_;
+    const std::uint8_t* data_;
+};
+
+struct TablebaseStats {
+    std::uint64_t wins, draws, losses;
+    int longestPlies;               // longest forced mate, white to move
+    double seconds;
+};
+
+// All tables in use, generated here or loaded from disk
+class Tablebases {
+public:
+    // "KQK" for "kqk", "KRK" for "KKR"; empty if not a valid material of at
+    // most four pieces
+    static std::string canonicalMaterial(const std::string& material);
+
+    // Builds the table for material on the pool, first building every
+    // smaller table it can lead to by a capture or promotion. Tables that
+    // already exist are kept. report, if given, sees each finished table.
+    bool generate(const std::string& material, ThreadPool& pool,
+                  void (*report)(const std::string& material, const TablebaseStats& stats) = nullptr);
+    // Every generated table as <directory>/<material>.tb; loaded ones are
+    // on disk already
+    bool save(const std::string& directory) const;
+    // Every .tb file in directory; returns the number of tables loaded
+    int load(const std::string& directory);
+    bool has(const std::string& material) const;
+    int tableCount() const { return static_cast<int>(tables_.size()); }
+
+    // Exact result for the side to move, if the tables cover the position
+    bool probe(const ChessBoard& board, TablebaseResult& result) const;
+    // A move that keeps the best result: the fastest mate when winning, the
+    // slowest when losing
+    bool bestMove(const ChessBoard& board, Move& move) const;
+
+    // Encoded value of position for its side to move, or -1 if no table
+    // covers it. En passant rights are ignored.
+    int probeValue(const Position& position) const;
+
+private:
+    const EndgameTable* find(const std::string& material) const;
+    bool generateTable(const std::string& material, ThreadPool& pool, TablebaseStats& stats);
+
+    std::map<std::string, std::unique_ptr<EndgameTable>> tables_;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+#include <atomic>
+
+ThreadPool::ThreadPool(int threads) : busy_(0), quit_(false) {
+    if (threads <= 0) threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    for (int i = 0; i < threads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    taskReady_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    taskReady_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    allDone_.wait(lock, [this] { return tasks_.empty() && busy_ == 0; });
+}
+
+void ThreadPool::parallelFor(std::size_t count, std::size_t chunkSize,
+                             const std::function<void(std::size_t, std::size_t)>& body) {
+    if (chunkSize == 0) chunkSize = 1;
+
+    // One task per worker, each claiming chunks until none are left, so
+    // uneven chunks balance out without a task per chunk
+    std::atomic<std::size_t> next(0);
+    for (int i = 0; i < size(); ++i) {
+        submit([&next, count, chunkSize, &body]() {
+            for (;;) {
+                std::size_t begin = next.fetch_add(chunkSize);
+                if (begin >= count) return;
+                body(begin, begin + chunkSize < count ? begin + chunkSize : count);
+            }
+        });
+    }
+    wait();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskReady_.wait(lock, [this] { return quit_ || !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+            ++busy_;
+        }
+
+        task();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busy_;
+            if (tasks_.empty() && busy_ == 0) allDone_.notify_all();
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for batch tools. Tasks run in submission
+// order as workers become free; wait() blocks until all of them are done.
+class ThreadPool {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    void submit(std::function<void()> task);
+    void wait();
+
+    // Calls body(begin, end) over [0, count) in chunks of at most chunkSize
+    // indices, spread over the workers; blocks until every chunk is done
+    void parallelFor(std::size_t count, std::size_t chunkSize,
+                     const std::function<void(std::size_t, std::size_t)>& body);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable taskReady_;
+    std::condition_variable allDone_;
+    int busy_;
+    bool quit_;
+};
+
+#endif
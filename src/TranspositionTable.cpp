@@ -0,0 +1,89 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) : bucketCount_(0), generation_(0) {
+    resize(megabytes);
+}
+
+void TranspositionTable::resize(std::size_t megabytes) {
+    std::size_t bytes = (megabytes > 0 ? megabytes : 1) * 1024 * 1024;
+    std::size_t count = 1;
+    while (count * 2 * sizeof(Bucket) <= bytes) count *= 2;
+
+    buckets_.reset(new Bucket[count]);
+    bucketCount_ = count;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < bucketCount_; ++i) {
+        for (Entry& entry : buckets_[i].entries) {
+            entry.keyXorData.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation_ = 0;
+}
+
+std::uint64_t TranspositionTable::pack(Move move, int score, int depth, Bound bound, std::uint8_t generation) {
+    return static_cast<std::uint64_t>(move.raw()) |
+           static_cast<std::uint64_t>(static_cast<std::uint16_t>(static_cast<std::int16_t>(score))) << 16 |
+           static_cast<std::uint64_t>(depth & 0xFF) << 32 |
+           static_cast<std::uint64_t>(bound) << 40 |
+           static_cast<std::uint64_t>(generation) << 48;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TableEntry& entry) const {
+    const Bucket& bucket = bucketFor(key);
+    for (const Entry& slot : bucket.entries) {
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) != key || boundOf(data) == BOUND_NONE) {
+            continue;
+        }
+        entry.move = Move::fromRaw(static_cast<std::uint16_t>(data));
+        entry.score = static_cast<std::int16_t>(data >> 16);
+        entry.depth = depthOf(data);
+        entry.bound = boundOf(data);
+        return true;
+    }
+    return false;
+}
+
+// Replaces the entry for the same key if there is one; otherwise the
+// shallowest entry, with entries from older searches counting as shallower
+void TranspositionTable::store(std::uint64_t key, int depth, Bound bound, int score, Move move) {
+    Bucket& bucket = bucketFor(key);
+    Entry* replace = &bucket.entries[0];
+    int replaceWorth = 1 << 30;
+
+    for (Entry& slot : bucket.entries) {
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        if ((slot.keyXorData.load(std::memory_order_relaxed) ^ data) == key) {
+            // Keep the old best move if this result has none
+            if (move.isNull()) move = Move::fromRaw(static_cast<std::uint16_t>(data));
+            replace = &slot;
+            break;
+        }
+        int age = static_cast<std::uint8_t>(generation_ - generationOf(data));
+        int worth = boundOf(data) == BOUND_NONE ? -(1 << 30) : depthOf(data) - 8 * age;
+        if (worth < replaceWorth) {
+            replaceWorth = worth;
+            replace = &slot;
+        }
+    }
+
+    std::uint64_t data = pack(move, score, depth, bound, generation_);
+    replace->keyXorData.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
+
+int TranspositionTable::hashfull() const {
+    const std::size_t sampleBuckets = bucketCount_ < 250 ? bucketCount_ : 250;
+    int used = 0;
+    for (std::size_t i = 0; i < sampleBuckets; ++i) {
+        for (const Entry& slot : buckets_[i].entries) {
+            std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (boundOf(data) != BOUND_NONE && generationOf(data) == generation_) ++used;
+        }
+    }
+    return static_cast<int>(used * 1000 / (sampleBuckets * BUCKET_SIZE));
+}
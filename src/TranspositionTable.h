@@ -0,0 +1,81 @@
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include "Move.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// How a stored score relates to the true score of the position
+enum Bound : std::uint8_t {
+    BOUND_NONE = 0,
+    BOUND_UPPER = 1,    // failed low: the true score is at most this
+    BOUND_LOWER = 2,    // failed high: the true score is at least this
+    BOUND_EXACT = 3
+};
+
+// What a probe found, unpacked
+struct TableEntry {
+    Move move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+// Fixed-size hash table of search results keyed by Zobrist key, shared by
+// any number of search threads without locks.
+//
+// Each entry is two 64-bit words, the packed data and the key XORed with
+// it. A probe accepts an entry only if the two words XOR back to its key,
+// so an entry torn by two threads writing at once just reads as a miss.
+// Four entries share one 64-byte bucket, so a probe touches a single cache
+// line. The bucket count is a power of two and the low key bits pick the
+// bucket.
+class TranspositionTable {
+public:
+    explicit TranspositionTable(std::size_t megabytes = 16);
+
+    // Reallocates and clears; the size is rounded down to a power of two
+    void resize(std::size_t megabytes);
+    void clear();
+    std::size_t sizeInBytes() const { return bucketCount_ * sizeof(Bucket); }
+
+    // Call once per search so entries from older searches are replaced first
+    void newSearch() { generation_ = static_cast<std::uint8_t>(generation_ + 1); }
+
+    bool probe(std::uint64_t key, TableEntry& entry) const;
+    void store(std::uint64_t key, int depth, Bound bound, int score, Move move);
+
+    // Permille of a sample of entries written during the current search
+    int hashfull() const;
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> keyXorData;
+        std::atomic<std::uint64_t> data;
+    };
+
+    static const int BUCKET_SIZE = 4;
+
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    // data layout: bits 0-15 move, 16-31 score, 32-39 depth, 40-41 bound,
+    // 48-55 generation
+    static std::uint64_t pack(Move move, int score, int depth, Bound bound, std::uint8_t generation);
+    static Bound boundOf(std::uint64_t data) { return static_cast<Bound>((data >> 40) & 3); }
+    static int depthOf(std::uint64_t data) { return static_cast<int>((data >> 32) & 0xFF); }
+    static std::uint8_t generationOf(std::uint64_t data) { return static_cast<std::uint8_t>(data >> 48); }
+
+    Bucket& bucketFor(std::uint64_t key) const { return buckets_[key & (bucketCount_ - 1)]; }
+
+    std::unique_ptr<Bucket[]> buckets_;
+    std::size_t bucketCount_;
+    std::uint8_t generation_;
+};
+
+static_assert(sizeof(std::atomic<std::uint64_t>) == 8, "table entries must be 16 bytes");
+
+#endif
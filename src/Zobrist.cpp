@@ -0,0 +1,44 @@
+#include "Zobrist.h"
+
+namespace {
+
+// splitmix64: a fixed seed gives the same keys in every build, so keys
+// written to disk stay valid
+constexpr std::uint64_t nextKey(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys makeKeys() {
+    ZobristKeys keys{};
+    std::uint64_t state = 0x2545F4914F6CDD1DULL;
+
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 6; ++type) {
+            for (int square = 0; square < 64; ++square) {
+                keys.pieces[color][type][square] = nextKey(state);
+            }
+        }
+    }
+
+    // One key per right; a set of rights is the XOR of its members
+    std::uint64_t rights[4] = {nextKey(state), nextKey(state), nextKey(state), nextKey(state)};
+    for (int set = 0; set < 16; ++set) {
+        keys.castling[set] = 0;
+        for (int bit = 0; bit < 4; ++bit) {
+            if (set & (1 << bit)) keys.castling[set] ^= rights[bit];
+        }
+    }
+
+    for (int file = 0; file < 8; ++file) {
+        keys.enPassant[file] = nextKey(state);
+    }
+    keys.side = nextKey(state);
+    return keys;
+}
+
+} // namespace
+
+constexpr ZobristKeys Zobrist = makeKeys();
@@ -0,0 +1,20 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Random keys for Zobrist hashing. A position's key is the XOR of one key per
+// (color, piece type, square), the castling-rights key, the en passant file
+// key when an en passant capture is possible, and the side key when black is
+// to move. The empty board with white to move hashes to 0.
+struct ZobristKeys {
+    std::uint64_t pieces[2][6][64];     // [colorIndex][PieceType - 1][square]
+    std::uint64_t castling[16];         // indexed by the CastlingRight bit set
+    std::uint64_t enPassant[8];         // indexed by file
+    std::uint64_t side;
+};
+
+// Generated at compile time, so it is usable from any static initializer
+extern const ZobristKeys Zobrist;
+
+#endif
@@ -0,0 +1,188 @@
+#include "ChessBoard.h"
+#include "Nnue.h"
+#include "ParallelSearch.h"
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless search benchmark. Searches a fixed set of positions to a fixed
+// depth and reports nodes per second; single-threaded, with the same build
+// and depth, the node counts are reproducible, so nps is comparable between
+// changes.
+
+namespace {
+
+const int DEFAULT_DEPTH = 6;
+const int DEFAULT_HASH_MB = 16;
+
+const char* const POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r1bq1rk1/pp2ppbp/2np1np1/8/3NP3/2N1BP2/PPPQ2PP/R3KB1R w KQ - 0 9",
+};
+
+std::string formatScore(int score) {
+    if (isMateScore(score)) {
+        int plies = MATE_SCORE - std::abs(score);
+        return std::string(score > 0 ? "mate " : "mated ") + std::to_string((plies + 1) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+// Searches one position from an empty table so every run starts from the
+// same state; prints a result line unless quiet. Returns false on a bad FEN.
+bool runPosition(const std::string& fen, const SearchLimits& limits, ParallelSearch& search,
+                 TranspositionTable& table, const NnueNetwork* network, bool quiet, SearchResult& result) {
+    Position position;
+    if (!position.setFromFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return false;
+    }
+    ChessBoard board;
+    board.setNetwork(network);
+    board.setPosition(position);
+
+    table.clear();
+    search.clearStop();
+    result = search.run(board, limits);
+    if (quiet) return true;
+
+    std::cout << "depth " << std::setw(2) << result.depth
+              << "  " << std::left << std::setw(9) << formatScore(result.score) << std::right
+              << "  best " << std::setw(5) << result.bestMove.toString()
+              << "  nodes " << std::setw(10) << result.nodes
+              << "  time " << std::fixed << std::setprecision(3) << result.seconds << "s"
+              << "  nps " << std::setw(9) << result.nps()
+              << "  hits " << std::setw(5) << std::setprecision(1) << result.hitRate() * 100 << "%"
+              << "  hashfull " << std::setw(4) << result.hashfull << std::endl;
+    return true;
+}
+
+// Runs the whole suite at 1, 2, 4, ... threads and maxThreads, and prints
+// throughput and time to depth, each relative to one thread
+bool runScaling(const SearchLimits& limits, TranspositionTable& table, const NnueNetwork* network, int maxThreads) {
+    double baseNps = 0;
+    double baseSeconds = 0;
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) threadCounts.push_back(threads);
+    threadCounts.push_back(maxThreads);
+
+    for (int threads : threadCounts) {
+        ParallelSearch search(table, threads);
+        std::uint64_t nodes = 0;
+        double seconds = 0;
+        for (const char* position : POSITIONS) {
+            SearchResult result;
+            if (!runPosition(position, limits, search, table, network, true, result)) return false;
+            nodes += result.nodes;
+            seconds += result.seconds;
+        }
+
+        double nps = seconds > 0 ? nodes / seconds : 0;
+        if (threads == 1) {
+            baseNps = nps;
+            baseSeconds = seconds;
+        }
+        std::cout << "threads " << std::setw(3) << threads
+                  << "  nodes " << std::setw(11) << nodes
+                  << "  time " << std::fixed << std::setprecision(3) << seconds << "s"
+                  << "  nps " << std::setw(10) << std::setprecision(0) << nps
+                  << "  nps x" << std::setprecision(2) << (baseNps > 0 ? nps / baseNps : 0)
+                  << "  time-to-depth x" << (seconds > 0 ? baseSeconds / seconds : 0) << std::endl;
+    }
+    return true;
+}
+
+void printUsage() {
+    std::cout << "Usage: bench [--depth N] [--nodes N] [--time MS] [--hash MB] [--threads N]\n"
+              << "             [--fen \"<FEN>\"] [--scaling [MAX_THREADS]] [--nnue FILE]\n"
+              << "  Searches the built-in positions (or the given FEN) to depth "
+              << DEFAULT_DEPTH << " unless\n"
+              << "  other limits are given, and reports nodes per second. The\n"
+              << "  transposition table defaults to " << DEFAULT_HASH_MB << " MB.\n"
+              << "  --scaling repeats the suite at 1, 2, 4, ... threads (default: all cores).\n"
+              << "  --nnue evaluates with the network in FILE instead of the hand-written\n"
+              << "  evaluation." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    SearchLimits limits;
+    std::string fen;
+    int hashMb = DEFAULT_HASH_MB;
+    int threads = 1;
+    int scalingThreads = 0;
+    std::string networkPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            limits.depth = std::atoi(argv[++i]);
+        } else if (arg == "--nodes" && i + 1 < argc) {
+            limits.nodes = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--time" && i + 1 < argc) {
+            limits.timeMs = std::atoi(argv[++i]);
+        } else if (arg == "--hash" && i + 1 < argc) {
+            hashMb = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg == "--scaling") {
+            scalingThreads = (i + 1 < argc && argv[i + 1][0] != '-') ? std::atoi(argv[++i])
+                                                                     : static_cast<int>(std::thread::hardware_concurrency());
+            if (scalingThreads < 1) scalingThreads = 1;
+        } else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (arg == "--nnue" && i + 1 < argc) {
+            networkPath = argv[++i];
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    if (limits.depth <= 0 && limits.nodes == 0 && limits.timeMs <= 0) {
+        limits.depth = DEFAULT_DEPTH;
+    }
+
+    std::unique_ptr<NnueNetwork> network;
+    if (!networkPath.empty()) {
+        network.reset(new NnueNetwork());
+        if (!network->load(networkPath)) {
+            std::cerr << "Cannot read network " << networkPath << std::endl;
+            return 1;
+        }
+    }
+
+    TranspositionTable table(hashMb > 0 ? hashMb : DEFAULT_HASH_MB);
+    if (scalingThreads > 0) {
+        return runScaling(limits, table, network.get(), scalingThreads) ? 0 : 1;
+    }
+
+    ParallelSearch search(table, threads);
+    SearchResult result;
+    if (!fen.empty()) {
+        return runPosition(fen, limits, search, table, network.get(), false, result) ? 0 : 1;
+    }
+
+    std::uint64_t totalNodes = 0;
+    double totalSeconds = 0;
+    for (const char* position : POSITIONS) {
+        if (!runPosition(position, limits, search, table, network.get(), false, result)) return 1;
+        totalNodes += result.nodes;
+        totalSeconds += result.seconds;
+    }
+
+    std::cout << "Total: " << totalNodes << " nodes in " << std::setprecision(3) << totalSeconds << "s ("
+              << std::setprecision(0) << (totalSeconds > 0 ? totalNodes / totalSeconds : 0) << " nps)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,733 @@
+#include "ChessBoard.h"
+#include "Evaluate.h"
+#include "GameDb.h"
+#include "MappedFile.h"
+#include "Nnue.h"
+#include "Notation.h"
+#include "Pgn.h"
+#include "PolyglotBook.h"
+#include "Tablebase.h"
+#include "PositionIndex.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Batch tools for position and game files. Each subcommand spreads its
+// work over a thread pool and reports throughput.
+
+namespace {
+
+// Lines read, processed in parallel and written back per batch, so output
+// order matches input order and memory stays bounded on huge files
+const std::size_t EPD_BATCH_LINES = 1 << 16;
+const std::size_t EPD_CHUNK_LINES = 64;
+
+// EPD has the first four FEN fields followed by operations ("bm e4;");
+// plain FEN lines with both clocks are accepted too
+std::string epdToFen(const std::string& line) {
+    std::istringstream stream(line);
+    std::string fen, field;
+    for (int i = 0; i < 6 && stream >> field; ++i) {
+        bool isNumber = field.find_first_not_of("0123456789") == std::string::npos;
+        if (i >= 4 && !isNumber) break;
+        fen += (i ? " " : "") + field;
+    }
+    return fen;
+}
+
+// One output line: the position's EPD fields, then legal move count, game
+// status and the perft count as EPD operations
+std::string analyseEpdLine(ChessBoard& board, const std::string& line, int depth) {
+    std::string fen = epdToFen(line);
+    if (!board.setFen(fen)) return line + " error invalid position;";
+
+    // Move count and status come from the same cached generation
+    int legalMoves = board.getCachedLegalMoves().size();
+    GameStatus gameStatus = board.getStatus();
+    const char* status = gameStatus == GameStatus::CHECKMATE ? "checkmate"
+                       : gameStatus == GameStatus::STALEMATE ? "stalemate"
+                       : gameStatus == GameStatus::CHECK ? "check" : "normal";
+
+    // Drop the clocks, which EPD leaves out
+    std::string epd = board.getFen();
+    epd.erase(epd.rfind(' ', epd.rfind(' ') - 1));
+
+    std::string result = epd + " legal " + std::to_string(legalMoves) + "; status " + status + ";";
+    if (depth > 0) {
+        result += " D" + std::to_string(depth) + " " + std::to_string(board.perft(depth)) + ";";
+    }
+    return result;
+}
+
+int runEpd(const std::string& inputPath, const std::string& outputPath, int depth, int threads) {
+    std::ifstream input(inputPath);
+    if (!input) {
+        std::cerr << "Cannot open " << inputPath << std::endl;
+        return 1;
+    }
+    std::ofstream output(outputPath);
+    if (!output) {
+        std::cerr << "Cannot create " << outputPath << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    std::vector<std::string> lines, results;
+    std::uint64_t positions = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+        lines.clear();
+        std::string line;
+        while (lines.size() < EPD_BATCH_LINES && std::getline(input, line)) {
+            if (line.find_first_not_of(" \t\r") != std::string::npos) lines.push_back(line);
+        }
+        if (lines.empty()) break;
+
+        results.assign(lines.size(), std::string());
+        pool.parallelFor(lines.size(), EPD_CHUNK_LINES, [&](std::size_t begin, std::size_t end) {
+            ChessBoard board;
+            for (std::size_t i = begin; i < end; ++i) {
+                results[i] = analyseEpdLine(board, lines[i], depth);
+            }
+        });
+
+        for (const std::string& result : results) {
+            output << result << '\n';
+        }
+        positions += lines.size();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << positions << " positions in " << std::fixed << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(0) << (seconds > 0 ? positions / seconds : 0) << " positions/s, "
+              << pool.size() << " threads)" << std::endl;
+    return 0;
+}
+
+// Games are split off the mapped file and replayed in batches, and the
+// pages behind each finished batch are released, so memory use does not
+// grow with the file
+const std::size_t PGN_BATCH_GAMES = 1 << 14;
+const std::size_t PGN_CHUNK_GAMES = 16;
+
+int runPgn(const std::string& path, int threads, int maxErrors) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    PgnSplitter splitter(file.data(), file.size());
+    std::vector<PgnGameText> games;
+    std::vector<std::string> errors;
+    std::uint64_t gameCount = 0, errorCount = 0;
+    std::atomic<std::uint64_t> plies(0);
+    auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+        games.clear();
+        PgnGameText game;
+        while (games.size() < PGN_BATCH_GAMES && splitter.next(game)) {
+            games.push_back(game);
+        }
+        if (games.empty()) break;
+
+        errors.assign(games.size(), std::string());
+        pool.parallelFor(games.size(), PGN_CHUNK_GAMES, [&](std::size_t begin, std::size_t end) {
+            ChessBoard board;
+            PgnReplay replay;
+            std::uint64_t chunkPlies = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                if (!replayPgnGame(games[i], board, replay)) errors[i] = replay.error;
+                chunkPlies += replay.plies;
+            }
+            plies += chunkPlies;
+        });
+
+        for (std::size_t i = 0; i < games.size(); ++i) {
+            if (errors[i].empty()) continue;
+            if (static_cast<int>(errorCount) < maxErrors) {
+                std::cout << "game " << gameCount + i + 1 << " (byte " << games[i].offset << "): "
+                          << errors[i] << std::endl;
+            }
+            ++errorCount;
+        }
+        gameCount += games.size();
+        file.release(splitter.position());
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << gameCount << " games, " << plies << " moves, " << errorCount << " with errors in "
+              << std::fixed << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(0) << (seconds > 0 ? gameCount / seconds : 0) << " games/s, "
+              << (seconds > 0 ? plies / seconds : 0) << " moves/s, " << pool.size() << " threads)" << std::endl;
+    return errorCount == 0 ? 0 : 2;
+}
+
+// One converted game, filled in by a pool thread and written in file order
+struct ConvertedGame {
+    std::string fen;
+    std::vector<Move> moves;
+    GameResult result;
+    std::string error;
+};
+
+int runPgnToDb(const std::string& inputPath, const std::string& outputPath, int threads, int maxErrors) {
+    MappedFile file;
+    if (!file.open(inputPath)) {
+        std::cerr << "Cannot open " << inputPath << std::endl;
+        return 1;
+    }
+    GameDbWriter writer;
+    if (!writer.open(outputPath)) {
+        std::cerr << "Cannot create " << outputPath << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    PgnSplitter splitter(file.data(), file.size());
+    std::vector<PgnGameText> games;
+    std::vector<ConvertedGame> converted;
+    std::uint64_t gameCount = 0, errorCount = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (;;) {
+        games.clear();
+        PgnGameText game;
+        while (games.size() < PGN_BATCH_GAMES && splitter.next(game)) {
+            games.push_back(game);
+        }
+        if (games.empty()) break;
+
+        converted.assign(games.size(), ConvertedGame());
+        pool.parallelFor(games.size(), PGN_CHUNK_GAMES, [&](std::size_t begin, std::size_t end) {
+            ChessBoard board;
+            PgnReplay replay;
+            for (std::size_t i = begin; i < end; ++i) {
+                ConvertedGame& out = converted[i];
+                pgnTag(games[i], "FEN", out.fen);
+                bool ok = replayPgnGame(games[i], board, replay,
+                                        [&out](const ChessBoard&, Move move) { out.moves.push_back(move); });
+                if (!ok) {
+                    out.error = replay.error;
+                    continue;
+                }
+                std::string result = replay.result;
+                if (result.empty()) pgnTag(games[i], "Result", result);
+                out.result = gameResultFromText(result);
+            }
+        });
+
+        // Games that do not replay or do not fit the format are left out of
+        // the database
+        for (std::size_t i = 0; i < games.size(); ++i) {
+            const ConvertedGame& out = converted[i];
+            std::string error = out.error;
+            if (error.empty()) {
+                if (writer.addGame(out.fen, out.moves, out.result)) continue;
+                if (writer.writeFailed()) {
+                    std::cerr << "Error writing " << outputPath << std::endl;
+                    return 1;
+                }
+                error = "too long for the database";
+            }
+            if (static_cast<int>(errorCount) < maxErrors) {
+                std::cout << "game " << gameCount + i + 1 << " (byte " << games[i].offset << "): "
+                          << error << " - skipped" << std::endl;
+            }
+            ++errorCount;
+        }
+        gameCount += games.size();
+        file.release(splitter.position());
+    }
+
+    if (!writer.close()) {
+        std::cerr << "Error writing " << outputPath << std::endl;
+        return 1;
+    }
+    std::ifstream written(outputPath, std::ios::binary | std::ios::ate);
+    double outputSize = static_cast<double>(written.tellg());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << writer.gameCount() << " of " << gameCount << " games written in " << std::fixed
+              << std::setprecision(3) << seconds << "s, " << file.size() << " -> "
+              << static_cast<std::uint64_t>(outputSize) << " bytes (" << std::setprecision(1)
+              << (outputSize > 0 ? file.size() / outputSize : 0) << "x smaller)" << std::endl;
+    return errorCount == 0 ? 0 : 2;
+}
+
+// Prints one game as PGN movetext, or replays them all and reports speed
+int runDb(const std::string& path, int threads, long long gameNumber, bool verify) {
+    GameDb db;
+    if (!db.open(path)) {
+        std::cerr << "Cannot open " << path << " or it is not a game database" << std::endl;
+        return 1;
+    }
+
+    if (gameNumber > 0) {
+        if (static_cast<std::uint64_t>(gameNumber) > db.gameCount()) {
+            std::cerr << "The database has " << db.gameCount() << " games" << std::endl;
+            return 1;
+        }
+        std::uint64_t game = gameNumber - 1;
+        GameDbEntry info = db.entry(game);
+        ChessBoard board;
+        if (info.fenLength > 0) {
+            if (!board.setFen(db.startFen(game))) {
+                std::cerr << "Game " << gameNumber << " has an invalid start position: " << db.startFen(game) << std::endl;
+                return 2;
+            }
+            std::cout << "[FEN \"" << db.startFen(game) << "\"]\n" << std::endl;
+        }
+        for (int ply = 0; ply < info.plies; ++ply) {
+            // The file may be damaged or foreign, so play only legal moves
+            Move move = db.move(game, ply);
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (!moves.contains(move)) {
+                std::cout << std::endl;
+                std::cerr << "Game " << gameNumber << " has an illegal move at ply " << ply + 1 << std::endl;
+                return 2;
+            }
+            if (board.getCurrentPlayer() == PieceColor::WHITE || ply == 0) {
+                std::cout << board.getPosition().fullmoveNumber()
+                          << (board.getCurrentPlayer() == PieceColor::WHITE ? ". " : "... ");
+            }
+            std::cout << moveToSan(board, move) << ' ';
+            board.makeMove(move);
+        }
+        std::cout << gameResultText(info.result) << std::endl;
+        return 0;
+    }
+
+    ThreadPool pool(threads);
+    std::atomic<std::uint64_t> plies(0), failed(0);
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(db.gameCount(), PGN_CHUNK_GAMES * 4, [&](std::size_t begin, std::size_t end) {
+        ChessBoard board;
+        std::uint64_t chunkPlies = 0, chunkFailed = 0;
+        for (std::size_t game = begin; game < end; ++game) {
+            if (db.replay(game, board, verify)) {
+                chunkPlies += board.getHistorySize();
+            } else {
+                ++chunkFailed;
+            }
+        }
+        plies += chunkPlies;
+        failed += chunkFailed;
+    });
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << db.gameCount() << " games, " << plies << " moves, " << failed << " failed in "
+              << std::fixed << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(0) << (seconds > 0 ? db.gameCount() / seconds : 0) << " games/s, "
+              << (seconds > 0 ? plies / seconds : 0) << " moves/s, " << pool.size() << " threads)" << std::endl;
+    return failed == 0 ? 0 : 2;
+}
+
+int runIndex(const std::string& dbPath, const std::string& indexPath, int threads) {
+    GameDb db;
+    if (!db.open(dbPath)) {
+        std::cerr << "Cannot open " << dbPath << " or it is not a game database" << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t skipped = 0;
+    if (!buildPositionIndex(db, indexPath, pool, skipped)) {
+        std::cerr << "Error writing " << indexPath << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    PositionIndex index;
+    index.open(indexPath);
+    std::cout << index.size() << " positions from " << db.gameCount() - skipped << " games indexed, " << skipped
+              << " skipped for an invalid start position, in " << std::fixed << std::setprecision(3) << seconds
+              << "s (" << pool.size() << " threads)" << std::endl;
+    return skipped == 0 ? 0 : 2;
+}
+
+// Games through a position: how often each move was played from it and
+// how those games ended
+int runQuery(const std::string& dbPath, const std::string& indexPath, const std::string& fen) {
+    GameDb db;
+    PositionIndex index;
+    if (!db.open(dbPath) || !index.open(indexPath)) {
+        std::cerr << "Cannot open " << dbPath << " and " << indexPath << std::endl;
+        return 1;
+    }
+    ChessBoard board;
+    if (!fen.empty() && !board.setFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    PositionStats stats;
+    auto start = std::chrono::steady_clock::now();
+    index.stats(board.getKey(), db, stats);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << stats.games << " games, " << stats.occurrences << " occurrences (query "
+              << std::fixed << std::setprecision(0) << micros << " us)" << std::endl;
+    for (const MoveStats& move : stats.moves) {
+        std::string name = move.move.isNull() ? "(end)" : moveToSan(board, move.move);
+        std::cout << std::left << std::setw(8) << name << std::right << std::setw(10) << move.count
+                  << "   +" << move.results[static_cast<int>(GameResult::WHITE_WINS)]
+                  << " =" << move.results[static_cast<int>(GameResult::DRAW)]
+                  << " -" << move.results[static_cast<int>(GameResult::BLACK_WINS)]
+                  << " *" << move.results[static_cast<int>(GameResult::UNKNOWN)] << std::endl;
+    }
+    if (!stats.sampleGames.empty()) {
+        std::cout << "games:";
+        for (std::uint32_t game : stats.sampleGames) std::cout << ' ' << game + 1;
+        std::cout << std::endl;
+    }
+    return 0;
+}
+
+// Book moves and weights for a position
+int runBook(const std::string& bookPath, const std::string& fen) {
+    PolyglotBook book;
+    if (!book.open(bookPath)) {
+        if (!book.hasKeys()) {
+            std::cerr << PolyglotBook::keysPath(bookPath) << " is missing or not the Polyglot Random64 table" << std::endl;
+        } else {
+            std::cerr << "Cannot open " << bookPath << std::endl;
+        }
+        return 1;
+    }
+    ChessBoard board;
+    if (!fen.empty() && !board.setFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    BookMove moves[PolyglotBook::MAX_MOVES];
+    auto start = std::chrono::steady_clock::now();
+    int count = book.probe(board, moves, PolyglotBook::MAX_MOVES);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    int total = 0;
+    for (int i = 0; i < count; ++i) total += moves[i].weight;
+    std::cout << "key " << std::hex << std::setw(16) << std::setfill('0') << book.key(board) << std::dec
+              << std::setfill(' ') << ", " << count << " moves of " << book.size() << " entries (probe "
+              << std::fixed << std::setprecision(0) << micros << " us)" << std::endl;
+    for (int i = 0; i < count; ++i) {
+        std::cout << std::left << std::setw(8) << moveToSan(board, moves[i].move) << std::right
+                  << std::setw(6) << moves[i].weight << std::setw(7) << std::setprecision(1)
+                  << (total ? 100.0 * moves[i].weight / total : 0) << "%" << std::endl;
+    }
+    return 0;
+}
+
+void reportTable(const std::string& material, const TablebaseStats& stats) {
+    std::cout << std::left << std::setw(6) << material << std::right << " " << stats.wins << " wins, "
+              << stats.draws << " draws, " << stats.losses << " losses, longest mate "
+              << (stats.longestPlies + 1) / 2 << " moves (" << std::fixed << std::setprecision(1)
+              << stats.seconds << "s)" << std::endl;
+}
+
+int runTablebaseGenerate(const std::string& directory, const std::vector<std::string>& materials, int threads) {
+    Tablebases tablebases;
+    tablebases.load(directory);
+    ThreadPool pool(threads);
+    for (const std::string& material : materials) {
+        if (Tablebases::canonicalMaterial(material).empty()) {
+            std::cerr << "Not a material of at most four pieces: " << material << std::endl;
+            return 1;
+        }
+        if (!tablebases.generate(material, pool, reportTable)) {
+            std::cerr << "Cannot build the " << material << " table" << std::endl;
+            return 1;
+        }
+    }
+    if (!tablebases.save(directory)) {
+        std::cerr << "Error writing tables to " << directory << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Result and best move from the tables, then the whole line to mate
+int runTablebaseProbe(const std::string& directory, const std::string& fen) {
+    Tablebases tablebases;
+    if (tablebases.load(directory) == 0) {
+        std::cerr << "No tables in " << directory << std::endl;
+        return 1;
+    }
+    ChessBoard board;
+    if (!board.setFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return 1;
+    }
+
+    TablebaseResult result;
+    auto start = std::chrono::steady_clock::now();
+    bool found = tablebases.probe(board, result);
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    if (!found) {
+        std::cout << "Not covered by the loaded tables" << std::endl;
+        return 2;
+    }
+    const char* side = board.getCurrentPlayer() == PieceColor::WHITE ? "White" : "Black";
+    if (result.outcome == TablebaseResult::WIN) {
+        std::cout << side << " mates in " << result.mateInMoves();
+    } else if (result.outcome == TablebaseResult::LOSS) {
+        std::cout << side << " is mated in " << result.plies / 2;
+    } else {
+        std::cout << "Draw";
+    }
+    std::cout << " (probe " << std::fixed << std::setprecision(0) << micros << " us)" << std::endl;
+
+    Move move;
+    int ply = 0;
+    while (result.outcome != TablebaseResult::DRAW && ply < result.plies && tablebases.bestMove(board, move)) {
+        if (ply == 0 || board.getCurrentPlayer() == PieceColor::WHITE) {
+            std::cout << board.getPosition().fullmoveNumber()
+                      << (board.getCurrentPlayer() == PieceColor::WHITE ? ". " : "... ");
+        }
+        std::cout << moveToSan(board, move) << ' ';
+        board.makeMove(move);
+        ++ply;
+    }
+    if (ply > 0) std::cout << std::endl;
+    return 0;
+}
+
+int runNnueGenerate(const std::string& path, bool random) {
+    NnueNetwork network;
+    if (random) {
+        network.randomize(1);
+    } else {
+        network.setFromEvaluation();
+    }
+    if (!network.save(path)) {
+        std::cerr << "Error writing " << path << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Evaluations per second of evaluateOne over positions, repeated passes times
+template <typename Function>
+double evaluationRate(std::size_t positions, int passes, Function evaluateOne) {
+    long long checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (std::size_t i = 0; i < positions; ++i) checksum += evaluateOne(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    volatile long long sink = checksum;     // keeps the loop from being optimized away
+    (void)sink;
+    return seconds > 0 ? positions * static_cast<double>(passes) / seconds : 0;
+}
+
+// Plays seeded random games with the network on the board. At every ply the
+// incrementally updated accumulators must equal a fresh refresh, and every
+// kernel must refresh and evaluate exactly like the scalar one. Then times
+// each kernel. Exits with 1 on any mismatch (ctest runs this).
+int runNnue(const std::string& path) {
+    const int GAMES = 200;
+    const int MAX_PLIES = 200;
+    const std::size_t BENCH_POSITIONS = 10000;
+    const int BENCH_PASSES = 20;
+
+    NnueNetwork network;
+    if (!network.load(path)) {
+        std::cerr << "Cannot read network " << path << std::endl;
+        return 1;
+    }
+    std::vector<NnueKernel> kernels;
+    for (NnueKernel kernel : {NnueKernel::SCALAR, NnueKernel::SSE2, NnueKernel::AVX2}) {
+        if (nnueKernelAvailable(kernel)) kernels.push_back(kernel);
+    }
+
+    ChessBoard board;
+    board.setNetwork(&network);
+    std::mt19937 random(1);
+    std::vector<Position> positions;
+    std::vector<NnueAccumulator> accumulators;
+    std::uint64_t checked = 0, updateErrors = 0, kernelErrors = 0;
+    for (int game = 0; game < GAMES; ++game) {
+        board.initializeBoard();
+        for (int ply = 0; ply < MAX_PLIES; ++ply) {
+            NnueAccumulator fresh;
+            network.refresh(board.getPosition(), PieceColor::WHITE, fresh, NnueKernel::SCALAR);
+            network.refresh(board.getPosition(), PieceColor::BLACK, fresh, NnueKernel::SCALAR);
+            if (std::memcmp(fresh.values, board.getAccumulator().values, sizeof(fresh.values)) != 0) ++updateErrors;
+            int expected = network.evaluate(fresh, board.getCurrentPlayer(), NnueKernel::SCALAR);
+            for (NnueKernel kernel : kernels) {
+                NnueAccumulator refreshed;
+                network.refresh(board.getPosition(), PieceColor::WHITE, refreshed, kernel);
+                network.refresh(board.getPosition(), PieceColor::BLACK, refreshed, kernel);
+                if (std::memcmp(fresh.values, refreshed.values, sizeof(fresh.values)) != 0 ||
+                    network.evaluate(board.getAccumulator(), board.getCurrentPlayer(), kernel) != expected) {
+                    ++kernelErrors;
+                }
+            }
+            ++checked;
+            if (positions.size() < BENCH_POSITIONS) {
+                positions.push_back(board.getPosition());
+                accumulators.push_back(board.getAccumulator());
+            }
+
+            MoveList moves;
+            board.getLegalMoves(moves);
+            if (moves.empty() || board.getPosition().halfmoveClock() >= 100) break;
+            board.makeMove(moves[random() % moves.size()]);
+        }
+        // Unmaking must bring back the accumulators of earlier plies untouched
+        while (board.getHistorySize() > 0) board.unmakeMove();
+        NnueAccumulator start;
+        network.refresh(board.getPosition(), PieceColor::WHITE, start, NnueKernel::SCALAR);
+        network.refresh(board.getPosition(), PieceColor::BLACK, start, NnueKernel::SCALAR);
+        if (std::memcmp(start.values, board.getAccumulator().values, sizeof(start.values)) != 0) ++updateErrors;
+    }
+
+    std::cout << checked << " positions from " << GAMES << " random games, kernels";
+    for (NnueKernel kernel : kernels) std::cout << ' ' << nnueKernelName(kernel);
+    std::cout << ": " << updateErrors << " accumulator mismatches, " << kernelErrors << " kernel mismatches" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << std::left << std::setw(8) << "eval" << std::right
+              << std::setw(14) << evaluationRate(positions.size(), BENCH_PASSES, [&](std::size_t i) {
+                     return evaluate(positions[i]);
+                 }) << " evals/s (hand-written)" << std::endl;
+    for (NnueKernel kernel : kernels) {
+        double incremental = evaluationRate(accumulators.size(), BENCH_PASSES, [&](std::size_t i) {
+            return network.evaluate(accumulators[i], positions[i].sideToMove(), kernel);
+        });
+        double full = evaluationRate(positions.size(), BENCH_PASSES / 4, [&](std::size_t i) {
+            return network.evaluate(positions[i], kernel);
+        });
+        std::cout << std::left << std::setw(8) << nnueKernelName(kernel) << std::right
+                  << std::setw(14) << incremental << " evals/s from accumulators, "
+                  << full << " with a full refresh" << std::endl;
+    }
+    return updateErrors == 0 && kernelErrors == 0 ? 0 : 1;
+}
+
+void printUsage() {
+    std::cout << "Usage: chesstool <command> [options]\n"
+              << "  epd <input.epd> <output> [--depth N] [--threads N]\n"
+              << "      legal move count, status and perft to depth N (default 0: none)\n"
+              << "      for every position; threads default to all cores\n"
+              << "  pgn <games.pgn> [--threads N] [--errors N]\n"
+              << "      replays every game against the rules and lists the first N\n"
+              << "      (default 20) illegal or unreadable games\n"
+              << "  pgn2db <games.pgn> <games.db> [--threads N] [--errors N]\n"
+              << "      converts PGN to the binary game database, skipping bad games\n"
+              << "  db <games.db> [--game N] [--verify] [--threads N]\n"
+              << "      prints game N, or replays every game and reports speed;\n"
+              << "      --verify checks each move against the legal moves\n"
+              << "  index <games.db> <games.idx> [--threads N]\n"
+              << "      builds the position index of a game database\n"
+              << "  query <games.db> <games.idx> [--fen FEN]\n"
+              << "      moves and results of the games through a position\n"
+              << "      (default the start position)\n"
+              << "  book <book.bin> [--fen FEN]\n"
+              << "      Polyglot book moves for a position; needs random64.txt, any text\n"
+              << "      copy of Polyglot's Random64 table, next to the book\n"
+              << "  tbgen <dir> <material>... [--threads N]\n"
+              << "      builds endgame tables such as KQK, KBNK or KQKR, with every\n"
+              << "      smaller table they need, and saves them in dir\n"
+              << "  tbprobe <dir> --fen FEN\n"
+              << "      result and mating line for a position of up to four pieces\n"
+              << "  nnuegen <net.nnue> [--random]\n"
+              << "      writes a network that reproduces the hand-written evaluation's\n"
+              << "      material and piece-square terms, or random weights\n"
+              << "  nnue <net.nnue>\n"
+              << "      checks incremental updates and every SIMD kernel against the\n"
+              << "      scalar code over random games, then reports evaluations/s" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+
+    std::vector<std::string> paths;
+    int depth = 0;
+    int threads = 0;
+    int maxErrors = 20;
+    long long gameNumber = 0;
+    bool verify = false;
+    bool random = false;
+    std::string fen;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else if (arg == "--game" && i + 1 < argc) {
+            gameNumber = std::atoll(argv[++i]);
+        } else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (arg == "--verify") {
+            verify = true;
+        } else if (arg == "--random") {
+            random = true;
+        } else if (arg == "--errors" && i + 1 < argc) {
+            maxErrors = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        } else if (arg.compare(0, 2, "--") != 0) {
+            paths.push_back(arg);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (command == "epd" && paths.size() == 2) {
+        return runEpd(paths[0], paths[1], depth, threads);
+    }
+    if (command == "pgn" && paths.size() == 1) {
+        return runPgn(paths[0], threads, maxErrors);
+    }
+    if (command == "pgn2db" && paths.size() == 2) {
+        return runPgnToDb(paths[0], paths[1], threads, maxErrors);
+    }
+    if (command == "db" && paths.size() == 1) {
+        return runDb(paths[0], threads, gameNumber, verify);
+    }
+    if (command == "index" && paths.size() == 2) {
+        return runIndex(paths[0], paths[1], threads);
+    }
+    if (command == "query" && paths.size() == 2) {
+        return runQuery(paths[0], paths[1], fen);
+    }
+    if (command == "tbgen" && paths.size() >= 2) {
+        return runTablebaseGenerate(paths[0], std::vector<std::string>(paths.begin() + 1, paths.end()), threads);
+    }
+    if (command == "tbprobe" && paths.size() == 1 && !fen.empty()) {
+        return runTablebaseProbe(paths[0], fen);
+    }
+    if (command == "nnuegen" && paths.size() == 1) {
+        return runNnueGenerate(paths[0], random);
+    }
+    if (command == "nnue" && paths.size() == 1) {
+        return runNnue(paths[0]);
+    }
+    if (command == "book" && paths.size() == 1) {
+        return runBook(paths[0], fen);
+    }
+    printUsage();
+    return command == "--help" ? 0 : 1;
+}
@@ -1,8 +1,28 @@
 #include "Game.h"
 #include <iostream>  // Add this line
+#include <string>
 
-int main() {
+int main(int argc, char* argv[]) {
     Game game;
+
+    // --ai white|black lets the engine play that side, --book gives it a
+    // Polyglot opening book, --tb a directory of endgame tables
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        std::string side = (arg == "--ai" && i + 1 < argc) ? argv[++i] : "";
+        if (arg == "--book" && i + 1 < argc) {
+            game.setBook(argv[++i]);
+        } else if (arg == "--tb" && i + 1 < argc) {
+            game.setTablebasePath(argv[++i]);
+        } else if (side == "white") {
+            game.setComputerColor(PieceColor::WHITE);
+        } else if (side == "black") {
+            game.setComputerColor(PieceColor::BLACK);
+        } else {
+            std::cerr << "Usage: ChessGame [--ai white|black] [--book book.bin] [--tb dir]" << std::endl;
+            return -1;
+        }
+    }
     
     if (!game.initialize()) {
         std::cerr << "Failed to initialize game!" << std::endl;
@@ -11,4 +31,4 @@ int main() {
     
     game.run();
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,128 @@
+#include "ChessBoard.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+// Headless move-generation benchmark. Counts the leaf nodes of the legal
+// move tree to a fixed depth and checks them against published perft
+// results, so both speed and correctness of the move path can be tracked.
+
+namespace {
+
+struct PerftCase {
+    const char* name;
+    const char* fen;
+    int depth;                  // default depth for the suite run
+    std::uint64_t expected[7];  // expected[d] = nodes at depth d, 0 if unknown
+};
+
+// Reference positions and node counts from the Chess Programming Wiki perft page
+const PerftCase SUITE[] = {
+    {"Start position", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 6,
+     {1, 20, 400, 8902, 197281, 4865609, 119060324}},
+    {"Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 5,
+     {1, 48, 2039, 97862, 4085603, 193690690, 0}},
+    {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 6,
+     {1, 14, 191, 2812, 43238, 674624, 11030083}},
+    {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 5,
+     {1, 6, 264, 9467, 422333, 15833292, 706045033}},
+    {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 5,
+     {1, 44, 1486, 62379, 2103487, 89941194, 0}},
+    {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5,
+     {1, 46, 2079, 89890, 3894594, 164075551, 6923051137ULL}},
+};
+
+// Node count below each root move, the usual way to bisect a perft mismatch
+std::uint64_t divide(ChessBoard& board, int depth) {
+    MoveList moves;
+    board.getLegalMoves(moves);
+
+    std::uint64_t total = 0;
+    for (const Move& move : moves) {
+        board.makeMove(move);
+        std::uint64_t nodes = depth > 1 ? board.perft(depth - 1) : 1;
+        board.unmakeMove();
+        std::cout << "  " << move.toString() << ": " << nodes << std::endl;
+        total += nodes;
+    }
+    return total;
+}
+
+// Runs one position and prints a result line; returns false on a count mismatch
+bool runCase(const std::string& name, const std::string& fen, int depth,
+             std::uint64_t expected, bool showDivide, std::uint64_t& nodes) {
+    ChessBoard board;
+    if (!board.setFen(fen)) {
+        std::cerr << "Invalid FEN: " << fen << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    nodes = showDivide ? divide(board, depth) : board.perft(depth);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double nps = seconds > 0 ? nodes / seconds : 0;
+
+    bool ok = expected == 0 || nodes == expected;
+    std::cout << std::left << std::setw(16) << name << std::right
+              << " depth " << depth
+              << "  nodes " << std::setw(11) << nodes
+              << "  time " << std::fixed << std::setprecision(3) << seconds << "s"
+              << "  nps " << std::setw(10) << std::setprecision(0) << nps;
+    if (expected != 0) {
+        std::cout << (ok ? "  OK" : "  MISMATCH (expected " + std::to_string(expected) + ")");
+    }
+    std::cout << std::endl;
+    return ok;
+}
+
+void printUsage() {
+    std::cout << "Usage: perft [--depth N] [--fen \"<FEN>\"] [--divide]\n"
+              << "  Without --fen the reference suite runs at its default depths;\n"
+              << "  --depth overrides the depth, --divide prints per-root-move counts." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int depth = 0;
+    std::string fen;
+    bool showDivide = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--depth" && i + 1 < argc) {
+            depth = std::atoi(argv[++i]);
+        } else if (arg == "--fen" && i + 1 < argc) {
+            fen = argv[++i];
+        } else if (arg == "--divide") {
+            showDivide = true;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::uint64_t nodes = 0;
+    if (!fen.empty()) {
+        return runCase("Custom", fen, depth > 0 ? depth : 4, 0, showDivide, nodes) ? 0 : 1;
+    }
+
+    bool allOk = true;
+    std::uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const PerftCase& test : SUITE) {
+        int caseDepth = depth > 0 ? depth : test.depth;
+        std::uint64_t expected = caseDepth < 7 ? test.expected[caseDepth] : 0;
+        allOk &= runCase(test.name, test.fen, caseDepth, expected, showDivide, nodes);
+        totalNodes += nodes;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Total: " << totalNodes << " nodes in " << std::setprecision(3) << seconds << "s ("
+              << std::setprecision(0) << (seconds > 0 ? totalNodes / seconds : 0) << " nps)"
+              << (allOk ? "" : "  FAILURES") << std::endl;
+    return allOk ? 0 : 1;
+}
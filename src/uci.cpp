@@ -0,0 +1,266 @@
+#include "ChessBoard.h"
+#include "MoveGen.h"
+#include "Nnue.h"
+#include "ParallelSearch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+// Universal Chess Interface front end for GUIs and tournament managers.
+// The main thread only reads commands; each "go" runs the search on its
+// own thread, so "stop", "isready" and "quit" are answered while it thinks.
+
+namespace {
+
+const char* const ENGINE_NAME = "ChessGame";
+const int DEFAULT_HASH_MB = 16;
+const int MAX_HASH_MB = 4096;
+const int MAX_THREADS = 256;
+const int MOVE_OVERHEAD_MS = 30;    // allowance for GUI and pipe latency
+
+class UciEngine {
+public:
+    UciEngine() : table_(DEFAULT_HASH_MB), search_(table_, 1), infinite_(false), stopRequested_(false) {
+        board_.initializeBoard();
+        search_.setInfoCallback([this](const SearchResult& result) { sendInfo(result); });
+    }
+
+    ~UciEngine() { stopSearch(); }
+
+    // Returns false on "quit"
+    bool handleCommand(const std::string& line);
+
+private:
+    void send(const std::string& text);
+    void sendInfo(const SearchResult& result);
+    void setPosition(std::istringstream& args);
+    void setOption(std::istringstream& args);
+    void go(std::istringstream& args);
+    void stopSearch();
+    bool findMove(const std::string& text, Move& move) const;
+
+    TranspositionTable table_;
+    ParallelSearch search_;
+    ChessBoard board_;
+    std::unique_ptr<NnueNetwork> network_;  // EvalFile; none means the hand-written evaluation
+    std::thread searchThread_;
+    std::mutex outputMutex_;
+    bool infinite_;                     // "go infinite": hold bestmove until stop
+    std::atomic<bool> stopRequested_;
+};
+
+std::string formatScore(int score) {
+    if (isMateScore(score)) {
+        int plies = MATE_SCORE - std::abs(score);
+        int moves = (plies + 1) / 2;
+        return "mate " + std::to_string(score > 0 ? moves : -moves);
+    }
+    return "cp " + std::to_string(score);
+}
+
+void UciEngine::send(const std::string& text) {
+    std::lock_guard<std::mutex> lock(outputMutex_);
+    std::cout << text << std::endl;
+}
+
+void UciEngine::sendInfo(const SearchResult& result) {
+    std::ostringstream info;
+    info << "info depth " << result.depth
+         << " score " << formatScore(result.score)
+         << " nodes " << result.nodes
+         << " nps " << result.nps()
+         << " time " << static_cast<long long>(result.seconds * 1000)
+         << " hashfull " << result.hashfull
+         << " pv";
+    for (int i = 0; i < result.pvLength; ++i) {
+        info << ' ' << result.pv[i].toString();
+    }
+    send(info.str());
+}
+
+bool UciEngine::handleCommand(const std::string& line) {
+    std::istringstream args(line);
+    std::string command;
+    if (!(args >> command)) return true;
+
+    if (command == "uci") {
+        send(std::string("id name ") + ENGINE_NAME);
+        send("id author the ChessGame authors");
+        send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) +
+             " min 1 max " + std::to_string(MAX_HASH_MB));
+        send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+        send("option name EvalFile type string default <empty>");
+        send("uciok");
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        table_.clear();
+    } else if (command == "position") {
+        stopSearch();
+        setPosition(args);
+    } else if (command == "setoption") {
+        stopSearch();
+        setOption(args);
+    } else if (command == "go") {
+        stopSearch();
+        go(args);
+    } else if (command == "stop") {
+        stopSearch();
+    } else if (command == "quit") {
+        stopSearch();
+        return false;
+    } else {
+        send("info string unknown command: " + command);
+    }
+    return true;
+}
+
+// position [startpos | fen <FEN>] [moves <move>...]
+void UciEngine::setPosition(std::istringstream& args) {
+    std::string token;
+    args >> token;
+    if (token == "startpos") {
+        board_.initializeBoard();
+        args >> token;
+    } else if (token == "fen") {
+        std::string fen;
+        while (args >> token && token != "moves") {
+            fen += token + " ";
+        }
+        Position position;
+        if (!position.setFromFen(fen)) {
+            send("info string invalid fen: " + fen);
+            return;
+        }
+        board_.setPosition(position);
+    } else {
+        return;
+    }
+
+    if (token != "moves") return;
+    while (args >> token) {
+        Move move;
+        if (!findMove(token, move) || board_.isHistoryFull()) {
+            send("info string illegal move: " + token);
+            return;
+        }
+        board_.makeMove(move);
+    }
+}
+
+// setoption name <id> value <x>
+void UciEngine::setOption(std::istringstream& args) {
+    std::string token, name, value;
+    args >> token;
+    while (args >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    args >> value;
+
+    if (name == "Threads") {
+        search_.setThreadCount(std::max(1, std::min(MAX_THREADS, std::atoi(value.c_str()))));
+    } else if (name == "Hash") {
+        table_.resize(std::max(1, std::min(MAX_HASH_MB, std::atoi(value.c_str()))));
+    } else if (name == "EvalFile") {
+        std::unique_ptr<NnueNetwork> network;
+        if (!value.empty() && value != "<empty>") {
+            network.reset(new NnueNetwork());
+            if (!network->load(value)) {
+                send("info string cannot read network " + value);
+                return;
+            }
+        }
+        // The board points at the network, so switch it before the old one goes
+        board_.setNetwork(network.get());
+        network_ = std::move(network);
+    } else {
+        send("info string unknown option: " + name);
+    }
+}
+
+// go [depth N] [nodes N] [movetime MS] [wtime MS] [btime MS] [winc MS]
+//    [binc MS] [movestogo N] [infinite]
+void UciEngine::go(std::istringstream& args) {
+    SearchLimits limits;
+    int time[2] = {0, 0}, increment[2] = {0, 0};
+    int movesToGo = 0, moveTime = 0;
+    infinite_ = false;
+
+    std::string token;
+    while (args >> token) {
+        if (token == "depth") args >> limits.depth;
+        else if (token == "nodes") args >> limits.nodes;
+        else if (token == "movetime") args >> moveTime;
+        else if (token == "wtime") args >> time[0];
+        else if (token == "btime") args >> time[1];
+        else if (token == "winc") args >> increment[0];
+        else if (token == "binc") args >> increment[1];
+        else if (token == "movestogo") args >> movesToGo;
+        else if (token == "infinite") infinite_ = true;
+    }
+
+    if (moveTime > 0) {
+        limits.timeMs = std::max(1, moveTime - MOVE_OVERHEAD_MS);
+    } else {
+        int side = colorIndex(board_.getCurrentPlayer());
+        if (time[side] > 0) {
+            // An even share of the clock plus most of the increment, never
+            // more than a third of what is left
+            int share = time[side] / (movesToGo > 0 ? movesToGo + 1 : 30) + increment[side] * 3 / 4;
+            limits.timeMs = std::max(1, std::min(share, time[side] / 3) - MOVE_OVERHEAD_MS);
+        }
+    }
+    if (infinite_) limits = SearchLimits();
+
+    stopRequested_ = false;
+    search_.clearStop();
+    searchThread_ = std::thread([this, limits]() {
+        SearchResult result = search_.run(board_, limits);
+        // In infinite mode the GUI expects bestmove only after its stop
+        while (infinite_ && !stopRequested_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        send("bestmove " + result.bestMove.toString());
+    });
+}
+
+void UciEngine::stopSearch() {
+    if (!searchThread_.joinable()) return;
+    stopRequested_ = true;
+    search_.stop();
+    searchThread_.join();
+}
+
+// Matches coordinate notation against the legal moves, which supplies the
+// castling, en passant and promotion flags the text does not carry
+bool UciEngine::findMove(const std::string& text, Move& move) const {
+    MoveList moves;
+    board_.getLegalMoves(moves);
+    for (Move candidate : moves) {
+        if (candidate.toString() == text) {
+            move = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    std::ios::sync_with_stdio(false);
+    UciEngine engine;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (!engine.handleCommand(line)) break;
+    }
+    return 0;
+}